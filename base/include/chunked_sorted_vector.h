@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_CHUNKED_SORTED_VECTOR_H
+#define UTILS_BASE_CHUNKED_SORTED_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+namespace OHOS {
+
+/*
+ * ChunkedSortedVector has the interface of SortedVector, but keeps the items in a list of sorted chunks of at most
+ * CHUNK_CAPACITY items instead of one array, so that Add and Erase only shift items inside one chunk.
+ * The last item of each chunk is kept in a separate array searched to find the chunk of an item,
+ * and chunk sizes in a Fenwick tree to turn a chunk position into an index and back in O(log n).
+ * Add, Erase, IndexOf, OrderOf and operator[] are O(log n) plus the shift of up to CHUNK_CAPACITY items,
+ * a full chunk is split in two.
+ * Items can not be edited in place and there is no contiguous Array(), since either could break the order.
+ */
+template <class TYPE, bool AllowDuplicate = true>
+class ChunkedSortedVector {
+public:
+    using value_type = TYPE;
+    using size_type = std::size_t;
+
+    // about 8 KB of items per chunk, never less than 64 items
+    static constexpr size_t CHUNK_CAPACITY = (8192 / sizeof(TYPE) > 64) ? (8192 / sizeof(TYPE)) : 64;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TYPE;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TYPE*;
+        using reference = const TYPE&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return (*chunks_)[chunk_][pos_]; }
+        pointer operator->() const { return &(*chunks_)[chunk_][pos_]; }
+
+        const_iterator& operator++()
+        {
+            if (++pos_ == (*chunks_)[chunk_].size()) {
+                chunk_++;
+                pos_ = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        bool operator==(const const_iterator& rhs) const { return (chunk_ == rhs.chunk_) && (pos_ == rhs.pos_); }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+
+    private:
+        friend class ChunkedSortedVector;
+        const_iterator(const std::vector<std::vector<TYPE>>* chunks, size_t chunk, size_t pos)
+            : chunks_(chunks), chunk_(chunk), pos_(pos)
+        {
+        }
+
+        const std::vector<std::vector<TYPE>>* chunks_ = nullptr;
+        size_t chunk_ = 0;
+        size_t pos_ = 0;
+    };
+
+    ChunkedSortedVector() : size_(0) {}
+
+    explicit ChunkedSortedVector(const std::vector<TYPE>& invec) : size_(0)
+    {
+        std::vector<TYPE> sorted(invec);
+        std::sort(sorted.begin(), sorted.end());
+        Assign(sorted);
+    }
+
+    virtual ~ChunkedSortedVector() {}
+
+    inline void Clear()
+    {
+        chunks_.clear();
+        lasts_.clear();
+        tree_.clear();
+        size_ = 0;
+    }
+    inline size_t Size() const { return size_; }
+    inline bool IsEmpty() const { return size_ == 0; }
+
+    ssize_t IndexOf(const TYPE& item) const;
+    size_t OrderOf(const TYPE& item) const;
+
+    // index must be smaller than Size()
+    const TYPE& operator[](size_t index) const
+    {
+        std::pair<size_t, size_t> location = Locate(index);
+        return chunks_[location.first][location.second];
+    }
+
+    const TYPE& Back() const { return chunks_.back().back(); }
+    const TYPE& Front() const { return chunks_.front().front(); }
+
+    ssize_t Add(const TYPE& item);
+
+    // merge a vector into this one
+    size_t Merge(const std::vector<TYPE>& invec);
+    size_t Merge(const ChunkedSortedVector<TYPE, AllowDuplicate>& sortedVector);
+
+    // erase an item at index, returns the iterator to the item after it
+    const_iterator Erase(size_t index);
+
+    const_iterator Begin() const { return const_iterator(&chunks_, 0, 0); }
+    const_iterator End() const { return const_iterator(&chunks_, chunks_.size(), 0); }
+
+    static const ssize_t NOT_FOUND = -1;
+    static const ssize_t ADD_FAIL = -1;
+
+private:
+    // items before chunk, sum of the sizes of chunks [0, chunk)
+    size_t ItemsBefore(size_t chunk) const
+    {
+        size_t sum = 0;
+        for (size_t i = chunk; i > 0; i -= i & (~i + 1)) {
+            sum += tree_[i];
+        }
+        return sum;
+    }
+
+    void AddToChunkSize(size_t chunk, ssize_t delta)
+    {
+        for (size_t i = chunk + 1; i < tree_.size(); i += i & (~i + 1)) {
+            tree_[i] += delta;
+        }
+        size_ += delta;
+    }
+
+    // (chunk, position in chunk) of the item at index, by descending the Fenwick tree
+    std::pair<size_t, size_t> Locate(size_t index) const
+    {
+        size_t chunk = 0;
+        size_t step = 1;
+        while (step * 2 < tree_.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if ((chunk + step < tree_.size()) && (tree_[chunk + step] <= index)) {
+                chunk += step;
+                index -= tree_[chunk];
+            }
+        }
+        return std::make_pair(chunk, index);
+    }
+
+    // chunk sizes changed in number, rebuilds the Fenwick tree in O(chunks)
+    void Rebuild()
+    {
+        tree_.assign(chunks_.size() + 1, 0);
+        size_ = 0;
+        for (size_t i = 1; i < tree_.size(); i++) {
+            tree_[i] += chunks_[i - 1].size();
+            size_ += chunks_[i - 1].size();
+            size_t parent = i + (i & (~i + 1));
+            if (parent < tree_.size()) {
+                tree_[parent] += tree_[i];
+            }
+        }
+    }
+
+    // fills the chunks from sorted items, chunks are left half full so the next adds do not split at once
+    void Assign(const std::vector<TYPE>& sorted)
+    {
+        Clear();
+        const size_t fill = CHUNK_CAPACITY / 2;
+        for (auto it = sorted.begin(); it != sorted.end();) {
+            if (!AllowDuplicate && !chunks_.empty() && !(chunks_.back().back() < *it)) {
+                ++it;
+                continue;
+            }
+            if (chunks_.empty() || (chunks_.back().size() >= fill)) {
+                chunks_.emplace_back();
+                chunks_.back().reserve(CHUNK_CAPACITY);
+            }
+            chunks_.back().push_back(*it);
+            ++it;
+        }
+        for (auto& chunk : chunks_) {
+            lasts_.push_back(chunk.back());
+        }
+        Rebuild();
+    }
+
+    void SplitChunk(size_t chunk)
+    {
+        std::vector<TYPE>& full = chunks_[chunk];
+        std::vector<TYPE> upper;
+        upper.reserve(CHUNK_CAPACITY);
+        size_t half = full.size() / 2;
+        std::move(full.begin() + half, full.end(), std::back_inserter(upper));
+        full.erase(full.begin() + half, full.end());
+        lasts_[chunk] = full.back();
+        lasts_.insert(lasts_.begin() + chunk + 1, upper.back());
+        chunks_.insert(chunks_.begin() + chunk + 1, std::move(upper));
+        Rebuild();
+    }
+
+    std::vector<std::vector<TYPE>> chunks_;
+    std::vector<TYPE> lasts_;  // last item of each chunk
+    std::vector<size_t> tree_;  // Fenwick tree of chunk sizes, 1-based
+    size_t size_;
+};
+
+template <class TYPE, bool AllowDuplicate>
+ssize_t ChunkedSortedVector<TYPE, AllowDuplicate>::IndexOf(const TYPE& item) const
+{
+    // first chunk whose last item is not less than item holds the first equal item, if any
+    auto last = std::lower_bound(lasts_.begin(), lasts_.end(), item);
+    if (last == lasts_.end()) {
+        return NOT_FOUND;
+    }
+    size_t chunk = last - lasts_.begin();
+    auto it = std::lower_bound(chunks_[chunk].begin(), chunks_[chunk].end(), item);
+    if (!(*it == item)) {
+        return NOT_FOUND;
+    }
+    return ItemsBefore(chunk) + (it - chunks_[chunk].begin());
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t ChunkedSortedVector<TYPE, AllowDuplicate>::OrderOf(const TYPE& item) const
+{
+    auto last = std::upper_bound(lasts_.begin(), lasts_.end(), item);
+    if (last == lasts_.end()) {
+        return size_;
+    }
+    size_t chunk = last - lasts_.begin();
+    auto it = std::upper_bound(chunks_[chunk].begin(), chunks_[chunk].end(), item);
+    return ItemsBefore(chunk) + (it - chunks_[chunk].begin());
+}
+
+template <class TYPE, bool AllowDuplicate>
+ssize_t ChunkedSortedVector<TYPE, AllowDuplicate>::Add(const TYPE& item)
+{
+    if (!AllowDuplicate && (IndexOf(item) != NOT_FOUND)) {
+        return ADD_FAIL;
+    }
+    if (chunks_.empty()) {
+        chunks_.emplace_back();
+        chunks_.back().reserve(CHUNK_CAPACITY);
+        lasts_.push_back(item);
+        Rebuild();
+    }
+
+    // after equal items, like SortedVector; past the last chunk means at the end of the last one
+    size_t chunk = std::upper_bound(lasts_.begin(), lasts_.end(), item) - lasts_.begin();
+    if (chunk == chunks_.size()) {
+        chunk--;
+    }
+    if (chunks_[chunk].size() >= CHUNK_CAPACITY) {
+        SplitChunk(chunk);
+        if (!(item < lasts_[chunk])) {
+            chunk++;
+        }
+    }
+
+    std::vector<TYPE>& target = chunks_[chunk];
+    auto it = target.insert(std::upper_bound(target.begin(), target.end(), item), item);
+    if (it + 1 == target.end()) {
+        lasts_[chunk] = item;
+    }
+    AddToChunkSize(chunk, 1);
+    return ItemsBefore(chunk) + (it - target.begin());
+}
+
+template <class TYPE, bool AllowDuplicate>
+typename ChunkedSortedVector<TYPE, AllowDuplicate>::const_iterator
+ChunkedSortedVector<TYPE, AllowDuplicate>::Erase(size_t index)
+{
+    if (index >= size_) {
+        return End();
+    }
+    std::pair<size_t, size_t> location = Locate(index);
+    size_t chunk = location.first;
+    std::vector<TYPE>& target = chunks_[chunk];
+    target.erase(target.begin() + location.second);
+    if (target.empty()) {
+        chunks_.erase(chunks_.begin() + chunk);
+        lasts_.erase(lasts_.begin() + chunk);
+        Rebuild();
+        return const_iterator(&chunks_, chunk, 0);
+    }
+    AddToChunkSize(chunk, -1);
+    if (location.second == target.size()) {
+        lasts_[chunk] = target.back();
+        return const_iterator(&chunks_, chunk + 1, 0);
+    }
+    return const_iterator(&chunks_, chunk, location.second);
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t ChunkedSortedVector<TYPE, AllowDuplicate>::Merge(const std::vector<TYPE>& invec)
+{
+    ChunkedSortedVector<TYPE, AllowDuplicate> sortedVector(invec);
+    return Merge(sortedVector);
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t ChunkedSortedVector<TYPE, AllowDuplicate>::Merge(const ChunkedSortedVector<TYPE, AllowDuplicate>& sortedVector)
+{
+    std::vector<TYPE> merged;
+    merged.reserve(size_ + sortedVector.Size());
+    std::merge(Begin(), End(), sortedVector.Begin(), sortedVector.End(), std::back_inserter(merged));
+    Assign(merged);
+    return size_;
+}
+
+} // namespace OHOS
+#endif
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_CONCURRENT_HASH_MAP_H
+#define UTILS_BASE_CONCURRENT_HASH_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace OHOS {
+
+/*
+ * ConcurrentHashMap has the interface of SafeMap, but splits the keys over lock-striped shards,
+ * each of them an open addressing table. Threads working on keys of different shards never contend,
+ * and a lookup probes a flat array instead of walking tree nodes.
+ * Unlike SafeMap, entries are unordered, and K must be hashable by Hash and comparable by ==.
+ * K and V must be default constructible.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentHashMap {
+public:
+    static constexpr size_t DEFAULT_SHARDS = 64;
+
+    // shards is rounded up to a power of 2
+    explicit ConcurrentHashMap(size_t shards = DEFAULT_SHARDS)
+    {
+        shardCount_ = 1;
+        while (shardCount_ < shards) {
+            shardCount_ <<= 1;
+        }
+        shards_.reset(new Shard[shardCount_]);
+    }
+
+    ~ConcurrentHashMap() {}
+
+    ConcurrentHashMap(const ConcurrentHashMap& rhs) : ConcurrentHashMap(rhs.shardCount_)
+    {
+        CopyFrom(rhs);
+    }
+
+    ConcurrentHashMap& operator=(const ConcurrentHashMap& rhs)
+    {
+        if (&rhs != this) {
+            Clear();
+            CopyFrom(rhs);
+        }
+
+        return *this;
+    }
+
+    // when multithread calling size() return a tmp status, some threads may insert just after size() call
+    int Size()
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < shardCount_; i++) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            size += shards_[i].size;
+        }
+        return static_cast<int>(size);
+    }
+
+    // when multithread calling Empty() return a tmp status, some threads may insert just after Empty() call
+    bool IsEmpty()
+    {
+        return Size() == 0;
+    }
+
+    bool Insert(const K& key, const V& value)
+    {
+        uint64_t hash = Mix(Hash()(key));
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.Lookup(key, hash) != NOT_FOUND) {
+            return false;
+        }
+        shard.Add(key, value, hash);
+        return true;
+    }
+
+    void EnsureInsert(const K& key, const V& value)
+    {
+        uint64_t hash = Mix(Hash()(key));
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.Lookup(key, hash);
+        if (slot != NOT_FOUND) {
+            shard.entries[slot].second = value;
+            return;
+        }
+        shard.Add(key, value, hash);
+    }
+
+    bool Find(const K& key, V& value)
+    {
+        uint64_t hash = Mix(Hash()(key));
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.Lookup(key, hash);
+        if (slot == NOT_FOUND) {
+            return false;
+        }
+        value = shard.entries[slot].second;
+        return true;
+    }
+
+    bool FindOldAndSetNew(const K& key, V& oldValue, const V& newValue)
+    {
+        uint64_t hash = Mix(Hash()(key));
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.Lookup(key, hash);
+        if (slot == NOT_FOUND) {
+            return false;
+        }
+        oldValue = shard.entries[slot].second;
+        shard.entries[slot].second = newValue;
+        return true;
+    }
+
+    void Erase(const K& key)
+    {
+        uint64_t hash = Mix(Hash()(key));
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.Lookup(key, hash);
+        if (slot != NOT_FOUND) {
+            shard.Remove(slot);
+        }
+    }
+
+    void Clear()
+    {
+        for (size_t i = 0; i < shardCount_; i++) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            shards_[i].Reset();
+        }
+    }
+
+    size_t GetShardCount() const { return shardCount_; }
+
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr size_t MIN_CAPACITY = 8;
+    static constexpr uint8_t EMPTY = 0;
+    static constexpr uint8_t DELETED = 1;
+    static constexpr uint8_t FULL = 0x80;  // low 7 bits keep a piece of the hash, most mismatches skip the compare
+    static constexpr size_t CACHE_LINE = 64;
+
+    // a table with linear probing, capacity is always a power of 2, and kept at most 3/4 used
+    struct alignas(CACHE_LINE) Shard {
+        std::mutex mutex;
+        std::vector<uint8_t> tags;
+        std::vector<std::pair<K, V>> entries;
+        size_t size = 0;
+        size_t used = 0;  // size plus DELETED slots, all of them lengthen probes
+
+        static uint8_t Tag(uint64_t hash)
+        {
+            return static_cast<uint8_t>(FULL | (hash >> 57)); // 57: top 7 bits, slot and shard use the low ones
+        }
+
+        size_t Lookup(const K& key, uint64_t hash) const
+        {
+            if (size == 0) {
+                return NOT_FOUND;
+            }
+            size_t mask = tags.size() - 1;
+            uint8_t tag = Tag(hash);
+            for (size_t slot = static_cast<size_t>(hash) & mask; tags[slot] != EMPTY; slot = (slot + 1) & mask) {
+                if ((tags[slot] == tag) && (entries[slot].first == key)) {
+                    return slot;
+                }
+            }
+            return NOT_FOUND;
+        }
+
+        // key must not be in the table yet
+        void Add(const K& key, const V& value, uint64_t hash)
+        {
+            if ((used + 1) * 4 > tags.size() * 3) { // 4, 3: grow beyond 3/4 of capacity
+                // few live entries means mostly DELETED slots, drop them and keep the capacity
+                Rehash((size + 1) * 4 > tags.size() ? tags.size() * 2 : tags.size()); // 4, 2: over 1/4 live, double
+            }
+            size_t mask = tags.size() - 1;
+            size_t slot = static_cast<size_t>(hash) & mask;
+            while (tags[slot] >= FULL) {
+                slot = (slot + 1) & mask;
+            }
+            if (tags[slot] == EMPTY) {
+                used++;
+            }
+            tags[slot] = Tag(hash);
+            entries[slot].first = key;
+            entries[slot].second = value;
+            size++;
+        }
+
+        void Remove(size_t slot)
+        {
+            tags[slot] = DELETED;
+            entries[slot] = std::pair<K, V>(); // release what the value holds now, not at the next rehash
+            size--;
+            if (size == 0) {
+                std::fill(tags.begin(), tags.end(), EMPTY);
+                used = 0;
+            }
+        }
+
+        void Rehash(size_t capacity)
+        {
+            if (capacity < MIN_CAPACITY) {
+                capacity = MIN_CAPACITY;
+            }
+            std::vector<uint8_t> oldTags(capacity, EMPTY);
+            std::vector<std::pair<K, V>> oldEntries(capacity);
+            oldTags.swap(tags);
+            oldEntries.swap(entries);
+            size_t mask = capacity - 1;
+            for (size_t i = 0; i < oldTags.size(); i++) {
+                if (oldTags[i] < FULL) {
+                    continue;
+                }
+                size_t slot = static_cast<size_t>(Mix(Hash()(oldEntries[i].first))) & mask;
+                while (tags[slot] != EMPTY) {
+                    slot = (slot + 1) & mask;
+                }
+                tags[slot] = oldTags[i];
+                entries[slot] = std::move(oldEntries[i]);
+            }
+            used = size;
+        }
+
+        void Reset()
+        {
+            std::vector<uint8_t>().swap(tags);
+            std::vector<std::pair<K, V>>().swap(entries);
+            size = 0;
+            used = 0;
+        }
+    };
+
+    // std::hash of integers is the identity, spread the bits before picking shard and slot
+    static uint64_t Mix(size_t hash)
+    {
+        uint64_t h = static_cast<uint64_t>(hash);
+        h ^= h >> 33; // 33: finalizer of MurmurHash3
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33; // 33: finalizer of MurmurHash3
+        return h;
+    }
+
+    // the slot uses the low bits, the shard the high ones
+    Shard& GetShard(uint64_t hash) const
+    {
+        return shards_[static_cast<size_t>(hash >> 32) & (shardCount_ - 1)]; // 32: bits not used by slots of a shard
+    }
+
+    // a shard of rhs is copied out and unlocked before inserting, never holding locks of both maps at once,
+    // so a = b and b = a in two threads do not deadlock
+    void CopyFrom(const ConcurrentHashMap& rhs)
+    {
+        std::vector<std::pair<K, V>> copied;
+        for (size_t i = 0; i < rhs.shardCount_; i++) {
+            copied.clear();
+            {
+                std::lock_guard<std::mutex> lock(rhs.shards_[i].mutex);
+                const Shard& shard = rhs.shards_[i];
+                copied.reserve(shard.size);
+                for (size_t slot = 0; slot < shard.tags.size(); slot++) {
+                    if (shard.tags[slot] >= FULL) {
+                        copied.push_back(shard.entries[slot]);
+                    }
+                }
+            }
+            for (const auto& entry : copied) {
+                EnsureInsert(entry.first, entry.second);
+            }
+        }
+    }
+
+    size_t shardCount_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace OHOS
+#endif
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_EVENT_LOOP_H
+#define UTILS_EVENT_LOOP_H
+
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/event_reactor.h"
+
+struct signalfd_siginfo;
+
+namespace OHOS {
+namespace Utils {
+
+class EventHandler;
+class InotifyEventHandler;
+class SignalEventHandler;
+
+/*
+ * EventLoop runs an EventReactor in its own thread and dispatches fd events(sockets, pipes, eventfds...),
+ * timers and posted tasks there. All callbacks run in the loop thread, one at a time.
+ */
+class EventLoop {
+public:
+    using Callback = std::function<void ()>;
+    using Task = std::function<void ()>;
+    using SignalCallback = std::function<void (const struct signalfd_siginfo& info)>;
+    // see InotifyEventHandler, name is the entry changed inside a watched directory
+    using FileCallback = std::function<void (int wd, uint32_t mask, uint32_t cookie, const std::string& name)>;
+
+    static const uint32_t READ = EventReactor::READ_EVENT;
+    static const uint32_t WRITE = EventReactor::WRITE_EVENT;
+    // trigger mode, level triggered by default, see EventHandler
+    static const uint32_t EDGE_TRIGGERED = 0x0100;
+    static const uint32_t ONE_SHOT = 0x0200;
+
+    struct FdCallbacks {
+        Callback onRead;
+        Callback onWrite;
+        Callback onClose;  // peer hung up and nothing is left to read
+        Callback onError;
+    };
+
+    /*
+     * timeoutMs, clockId: see Timer, clockId is the clock of the timers added
+     * backend: see DemultiplexerBackend, io_uring falls back to epoll where it is not available
+     */
+    explicit EventLoop(const std::string& name, int timeoutMs = -1, clockid_t clockId = CLOCK_MONOTONIC,
+        DemultiplexerBackend backend = DemultiplexerBackend::EPOLL);
+    virtual ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    uint32_t Setup();
+
+    /*
+     * useJoin: see Timer::Shutdown
+     * fds and timers still registered are removed, the fds are not closed
+     */
+    void Shutdown(bool useJoin = true);
+
+    /*
+     * events: READ, WRITE or READ | WRITE, optionally | EDGE_TRIGGERED and/or ONE_SHOT,
+     *         a ONE_SHOT fd is re-armed by ModifyFd
+     * the fd is not owned by the loop and must stay open until RemoveFd
+     */
+    uint32_t AddFd(int fd, uint32_t events, const FdCallbacks& callbacks);
+    uint32_t ModifyFd(int fd, uint32_t events);
+
+    /*
+     * called in the loop thread(from a callback), no callback of fd runs after it returns
+     * called in another thread, a callback already running may not have finished yet
+     */
+    void RemoveFd(int fd);
+
+    // returns timer id, TIMER_ERR_DEAL_FAILED if failed
+    uint32_t AddTimer(const Callback& callback, std::chrono::nanoseconds interval, bool once = false);
+    void RemoveTimer(uint32_t timerId);
+
+    /*
+     * handle signo in the loop thread through a signalfd instead of a signal handler
+     * signo must be blocked(pthread_sigmask) in every thread, block it before creating any thread
+     */
+    uint32_t AddSignal(int signo, const SignalCallback& callback);
+    void RemoveSignal(int signo);
+
+    /*
+     * watch path with inotify instead of polling it, mask: IN_CREATE | IN_DELETE | IN_MODIFY...
+     * returns the watch descriptor, -1 if failed. Watching a path again replaces its mask and callback.
+     */
+    int WatchPath(const std::string& path, uint32_t mask, const FileCallback& callback);
+    void UnwatchPath(int wd);
+
+    // loop statistics, see Timer::EnableReactorStatistics
+    void EnableStatistics(bool enable, std::chrono::nanoseconds slowHandler = std::chrono::nanoseconds::zero())
+    {
+        reactor_->EnableStatistics(enable, static_cast<uint64_t>(slowHandler.count()));
+    }
+    ReactorStatistics GetStatistics() { return reactor_->GetStatistics(); }
+    void ResetStatistics() { reactor_->ResetStatistics(); }
+
+    // run task in the loop thread
+    void PostTask(const Task& task);
+    bool IsInLoopThread() const { return reactor_->IsInLoopThread(); }
+    DemultiplexerBackend GetBackend() const { return reactor_->GetBackend(); }
+
+private:
+    struct FdEntry;
+    using FdEntryPtr = std::shared_ptr<FdEntry>;
+
+    static uint32_t SetHandlerEvents(EventHandler& handler, uint32_t events);
+    void MainLoop();
+    void OnTimer(uint32_t timerId, bool once);
+    void OnSignal(const struct signalfd_siginfo& info);
+    void OnFileEvent(int wd, uint32_t mask, uint32_t cookie, const std::string& name);
+    void RemoveAll();
+    void ReleaseRemoved();
+    uint32_t GetNextTimerId();
+
+    std::string name_;
+    int timeoutMs_;
+    clockid_t clockId_;
+    std::thread thread_;
+    std::unique_ptr<EventReactor> reactor_;
+    std::mutex mutex_;
+    std::map<int, FdEntryPtr> fdEntries_;  // guard by mutex_
+    std::map<uint32_t, std::pair<int, Callback>> timers_;  // guard by mutex_, timer id to timerFd and callback
+    // removed but maybe still referenced by the dispatch in progress, released by a task posted to the loop
+    std::vector<FdEntryPtr> removedEntries_;  // guard by mutex_
+    std::vector<int> removedTimerFds_;  // guard by mutex_
+    std::unique_ptr<SignalEventHandler> signalHandler_;  // guard by mutex_, created at the first AddSignal
+    std::map<int, SignalCallback> signalCallbacks_;  // guard by mutex_
+    std::unique_ptr<InotifyEventHandler> inotifyHandler_;  // guard by mutex_, created at the first WatchPath
+    std::map<int, FileCallback> fileCallbacks_;  // guard by mutex_, watch descriptor to callback
+    uint32_t nextTimerId_;  // guard by mutex_
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_EVENT_LOOP_GROUP_H
+#define UTILS_EVENT_LOOP_GROUP_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "event_loop.h"
+
+namespace OHOS {
+namespace Utils {
+
+/*
+ * EventLoopGroup runs several EventLoops, each in its own thread optionally pinned to a core,
+ * and spreads fds over them. Callbacks of one fd always run in the loop it is assigned to,
+ * callbacks of fds in different loops run concurrently.
+ */
+class EventLoopGroup {
+public:
+    using Task = EventLoop::Task;
+
+    enum class AssignPolicy {
+        ROUND_ROBIN,  // next loop for every fd added
+        HASH_FD,      // loop chosen by fd number, the same fd always lands in the same loop
+    };
+
+    /*
+     * loops: number of loops, 0 means std::thread::hardware_concurrency()
+     * pinToCore: pin loop i to core i % number of cores
+     * timeoutMs, clockId, backend: see EventLoop
+     */
+    explicit EventLoopGroup(const std::string& name, uint32_t loops = 0,
+        AssignPolicy policy = AssignPolicy::ROUND_ROBIN, bool pinToCore = true, int timeoutMs = -1,
+        clockid_t clockId = CLOCK_MONOTONIC, DemultiplexerBackend backend = DemultiplexerBackend::EPOLL);
+    virtual ~EventLoopGroup();
+
+    EventLoopGroup(const EventLoopGroup&) = delete;
+    EventLoopGroup& operator=(const EventLoopGroup&) = delete;
+
+    uint32_t Setup();
+    void Shutdown(bool useJoin = true);
+
+    uint32_t GetLoopCount() const { return static_cast<uint32_t>(loops_.size()); }
+    // nullptr if index is out of range
+    EventLoop* GetLoop(uint32_t index);
+
+    /*
+     * add fd to the loop chosen by the policy, see EventLoop::AddFd
+     */
+    uint32_t AddFd(int fd, uint32_t events, const EventLoop::FdCallbacks& callbacks);
+    uint32_t ModifyFd(int fd, uint32_t events);
+    void RemoveFd(int fd);
+
+    // index of the loop fd is assigned to, -1 if fd is not added
+    int GetLoopIndex(int fd);
+
+    /*
+     * move fd with its events and callbacks to another loop, done in the current loop thread of fd
+     * so no callback of fd is running while it moves. Returns at once, TIMER_ERR_DEAL_FAILED if fd is
+     * moving already.
+     */
+    uint32_t MigrateFd(int fd, uint32_t toLoop);
+
+    // run task in loop index, the loop is woken up through its eventfd
+    uint32_t PostTask(uint32_t index, const Task& task);
+    // run task in the loop fd is assigned to
+    uint32_t PostTaskToFd(int fd, const Task& task);
+
+private:
+    struct FdRecord {
+        uint32_t loop;
+        uint32_t events;
+        EventLoop::FdCallbacks callbacks;
+        bool migrating;
+        uint32_t fromLoop;  // the loop a migrating fd is still in
+        uint64_t migration;  // the migration in progress, a pending DoMigrate of another one is stale
+    };
+
+    uint32_t PickLoop(int fd);
+    void PinToCore(uint32_t index);
+    void DoMigrate(int fd, uint32_t fromLoop, uint32_t toLoop, uint64_t migration);
+
+    std::string name_;
+    AssignPolicy policy_;
+    bool pinToCore_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::atomic<uint32_t> nextLoop_;
+    std::mutex mutex_;
+    std::unordered_map<int, FdRecord> records_;  // guard by mutex_
+    uint64_t migrations_;  // guard by mutex_
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
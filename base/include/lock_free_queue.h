@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_LOCK_FREE_QUEUE_H
+#define UTILS_BASE_LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace OHOS {
+
+/*
+ * Lock-free counterparts of SafeQueue and SafeStack for many producers and many consumers.
+ * Both preallocate their storage at construction and never allocate afterwards, so they are bounded:
+ * Push returns false instead of growing when capacity elements are stored.
+ * T must be default constructible and assignable.
+ * Size() and Empty() return a tmp status, like those of SafeQueue.
+ */
+
+namespace LockFreeDetail {
+constexpr size_t CACHE_LINE = 64;
+
+inline size_t RoundUpPowerOf2(size_t value)
+{
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace LockFreeDetail
+
+/*
+ * FIFO on a ring of cells, each with a sequence number telling whether it is ready for the producer or the consumer
+ * of the current lap. A push or a pop is one CAS on its index, plus the copy of the element.
+ */
+template <typename T>
+class LockFreeQueue {
+public:
+    // capacity is rounded up to a power of 2
+    explicit LockFreeQueue(size_t capacity)
+        : mask_(LockFreeDetail::RoundUpPowerOf2(capacity < 2 ? 2 : capacity) - 1), cells_(new Cell[mask_ + 1]),
+          enqueuePos_(0), dequeuePos_(0)
+    {
+        for (size_t i = 0; i <= mask_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~LockFreeQueue() {}
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    bool Push(const T& pt)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // the consumer of the previous lap has not taken this cell yet: full
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = pt;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& pt)
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // the producer of this lap has not filled this cell yet: empty
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        pt = cell->data;
+        cell->data = T(); // release what the element holds now, not when the cell is reused
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty()
+    {
+        return Size() == 0;
+    }
+
+    int Size()
+    {
+        size_t dequeuePos = dequeuePos_.load(std::memory_order_acquire);
+        size_t enqueuePos = enqueuePos_.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? static_cast<int>(enqueuePos - dequeuePos) : 0;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct alignas(LockFreeDetail::CACHE_LINE) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(LockFreeDetail::CACHE_LINE) std::atomic<size_t> enqueuePos_;
+    alignas(LockFreeDetail::CACHE_LINE) std::atomic<size_t> dequeuePos_;
+};
+
+/*
+ * LIFO as a Treiber stack over a pool of nodes linked by index. Free nodes form a second Treiber stack,
+ * so nodes are recycled instead of allocated. Each head packs a node index with a tag bumped by every change,
+ * so a head that was popped and pushed back in between (ABA) fails the CAS.
+ */
+template <typename T>
+class LockFreeStack {
+public:
+    explicit LockFreeStack(size_t capacity)
+        : nodes_(new Node[capacity == 0 ? 1 : capacity]), top_(Pack(NIL, 0)), free_(Pack(NIL, 0)), size_(0)
+    {
+        size_t count = (capacity == 0) ? 1 : capacity;
+        for (size_t i = 0; i < count; i++) {
+            nodes_[i].next.store(i + 1 < count ? static_cast<uint32_t>(i + 1) : NIL, std::memory_order_relaxed);
+        }
+        free_.store(Pack(0, 0), std::memory_order_relaxed);
+    }
+
+    ~LockFreeStack() {}
+
+    LockFreeStack(const LockFreeStack&) = delete;
+    LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+    bool Push(const T& pt)
+    {
+        uint32_t index = PopIndex(free_);
+        if (index == NIL) {
+            return false;
+        }
+        nodes_[index].data = pt;
+        PushIndex(top_, index);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Pop(T& pt)
+    {
+        uint32_t index = PopIndex(top_);
+        if (index == NIL) {
+            return false;
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        pt = nodes_[index].data;
+        nodes_[index].data = T();
+        PushIndex(free_, index);
+        return true;
+    }
+
+    bool Empty()
+    {
+        return Index(top_.load(std::memory_order_acquire)) == NIL;
+    }
+
+    int Size()
+    {
+        int size = size_.load(std::memory_order_relaxed);
+        return size > 0 ? size : 0;
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr int TAG_SHIFT = 32;
+
+    struct Node {
+        std::atomic<uint32_t> next;
+        T data;
+    };
+
+    static uint64_t Pack(uint32_t index, uint32_t tag)
+    {
+        return (static_cast<uint64_t>(tag) << TAG_SHIFT) | index;
+    }
+
+    static uint32_t Index(uint64_t head)
+    {
+        return static_cast<uint32_t>(head);
+    }
+
+    static uint32_t Tag(uint64_t head)
+    {
+        return static_cast<uint32_t>(head >> TAG_SHIFT);
+    }
+
+    // the node may be recycled by another thread after head is read, its next is then stale but the tag rejects it
+    uint32_t PopIndex(std::atomic<uint64_t>& head)
+    {
+        uint64_t old = head.load(std::memory_order_acquire);
+        while (Index(old) != NIL) {
+            uint32_t next = nodes_[Index(old)].next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old, Pack(next, Tag(old) + 1), std::memory_order_acquire,
+                std::memory_order_acquire)) {
+                return Index(old);
+            }
+        }
+        return NIL;
+    }
+
+    void PushIndex(std::atomic<uint64_t>& head, uint32_t index)
+    {
+        uint64_t old = head.load(std::memory_order_relaxed);
+        do {
+            nodes_[index].next.store(Index(old), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(old, Pack(index, Tag(old) + 1), std::memory_order_release,
+            std::memory_order_relaxed));
+    }
+
+    std::unique_ptr<Node[]> nodes_;
+    alignas(LockFreeDetail::CACHE_LINE) std::atomic<uint64_t> top_;
+    alignas(LockFreeDetail::CACHE_LINE) std::atomic<uint64_t> free_;
+    alignas(LockFreeDetail::CACHE_LINE) std::atomic<int> size_;
+};
+
+} // namespace OHOS
+#endif
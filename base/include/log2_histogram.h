@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_LOG2_HISTOGRAM_H
+#define UTILS_BASE_LOG2_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace OHOS {
+
+/*
+ * log2 histogram of the statistics of Timer, EventReactor and SafeBlockQueue,
+ * bucket 0 counts value 0, bucket i counts values in [2^(i-1), 2^i)
+ */
+struct Log2Histogram {
+    static constexpr size_t BUCKETS = 65;
+
+    std::array<uint64_t, BUCKETS> buckets {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void Add(uint64_t value)
+    {
+        size_t bucket = 0;
+        for (uint64_t v = value; v != 0; v >>= 1) {
+            bucket++;
+        }
+        buckets[bucket]++;
+        count++;
+        sum += value;
+        max = (value > max) ? value : max;
+    }
+};
+
+} // namespace OHOS
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_READ_MOSTLY_MAP_H
+#define UTILS_BASE_READ_MOSTLY_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace OHOS {
+
+/*
+ * ReadMostlyMap has the interface of SafeMap, for maps written rarely and read very often.
+ * Readers never take a lock: they search an immutable snapshot, a sorted array, with a fixed number of atomic
+ * operations. Every write copies the entries into a new snapshot and publishes it at once, then waits until no
+ * reader can still see the old one before freeing it, so writes cost O(n) plus the longest running read.
+ * Use Update() to apply many changes with one copy.
+ */
+template <typename K, typename V>
+class ReadMostlyMap {
+public:
+    ReadMostlyMap() : current_(new Snapshot()), epoch_(0) {}
+
+    ~ReadMostlyMap()
+    {
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    ReadMostlyMap(const ReadMostlyMap& rhs) : ReadMostlyMap()
+    {
+        std::lock_guard<std::mutex> lock(rhs.writeMutex_);
+        master_ = rhs.master_;
+        Publish();
+    }
+
+    ReadMostlyMap& operator=(const ReadMostlyMap& rhs)
+    {
+        if (&rhs != this) {
+            std::map<K, V> copied;
+            {
+                std::lock_guard<std::mutex> lock(rhs.writeMutex_);
+                copied = rhs.master_;
+            }
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            master_.swap(copied);
+            Publish();
+        }
+
+        return *this;
+    }
+
+    // when multithread calling size() return a tmp status, some threads may insert just after size() call
+    int Size()
+    {
+        ReadGuard guard(*this);
+        return static_cast<int>(guard.snapshot->size());
+    }
+
+    // when multithread calling Empty() return a tmp status, some threads may insert just after Empty() call
+    bool IsEmpty()
+    {
+        ReadGuard guard(*this);
+        return guard.snapshot->empty();
+    }
+
+    bool Find(const K& key, V& value)
+    {
+        ReadGuard guard(*this);
+        const Snapshot& snapshot = *guard.snapshot;
+        auto iter = std::lower_bound(snapshot.begin(), snapshot.end(), key,
+            [](const std::pair<K, V>& entry, const K& k) { return entry.first < k; });
+        if ((iter == snapshot.end()) || (key < iter->first)) {
+            return false;
+        }
+        value = iter->second;
+        return true;
+    }
+
+    bool Insert(const K& key, const V& value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        if (!master_.insert(std::pair<K, V>(key, value)).second) {
+            return false;
+        }
+        Publish();
+        return true;
+    }
+
+    void EnsureInsert(const K& key, const V& value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        master_[key] = value;
+        Publish();
+    }
+
+    bool FindOldAndSetNew(const K& key, V& oldValue, const V& newValue)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto iter = master_.find(key);
+        if (iter == master_.end()) {
+            return false;
+        }
+        oldValue = iter->second;
+        iter->second = newValue;
+        Publish();
+        return true;
+    }
+
+    void Erase(const K& key)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        if (master_.erase(key) > 0) {
+            Publish();
+        }
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        master_.clear();
+        Publish();
+    }
+
+    // applies all changes made by updates to the entries, then publishes them to readers at once
+    void Update(const std::function<void (std::map<K, V>& entries)>& updates)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        updates(master_);
+        Publish();
+    }
+
+private:
+    using Snapshot = std::vector<std::pair<K, V>>;
+
+    static constexpr size_t READER_STRIPES = 32;
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) ReaderCount {
+        std::atomic<size_t> count{0};
+    };
+
+    // a reader announces itself in the counters of the current epoch parity before loading the snapshot
+    struct ReadGuard {
+        explicit ReadGuard(ReadMostlyMap& map)
+            : counter(map.readers_[map.epoch_.load(std::memory_order_relaxed) & 1][ReaderStripe()].count)
+        {
+            counter.fetch_add(1, std::memory_order_seq_cst);
+            snapshot = map.current_.load(std::memory_order_seq_cst);
+        }
+
+        ~ReadGuard()
+        {
+            counter.fetch_sub(1, std::memory_order_release);
+        }
+
+        std::atomic<size_t>& counter;
+        const Snapshot* snapshot;
+    };
+
+    // threads are spread over stripes so that readers rarely share a counter
+    static size_t ReaderStripe()
+    {
+        static std::atomic<size_t> nextStripe(0);
+        thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % READER_STRIPES;
+        return stripe;
+    }
+
+    // writeMutex_ must be held
+    void Publish()
+    {
+        const Snapshot* old = current_.exchange(new Snapshot(master_.begin(), master_.end()),
+            std::memory_order_seq_cst);
+        WaitForReaders();
+        delete old;
+    }
+
+    /*
+     * Readers of both parities are drained one after the other. A reader counted in a parity after it was drained
+     * has loaded the snapshot after the exchange, so none can still hold the old one when this returns.
+     */
+    void WaitForReaders()
+    {
+        for (int round = 0; round < 2; round++) { // 2: both parities
+            size_t parity = epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+            for (auto& reader : readers_[parity]) {
+                while (reader.count.load(std::memory_order_acquire) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    std::atomic<const Snapshot*> current_;
+    std::atomic<size_t> epoch_;
+    ReaderCount readers_[2][READER_STRIPES]; // 2: indexed by epoch parity
+    mutable std::mutex writeMutex_;
+    std::map<K, V> master_;  // what the next snapshot is built from, only touched under writeMutex_
+};
+
+} // namespace OHOS
+#endif
@@ -18,56 +18,171 @@
 
 #include <climits>
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <queue>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "log2_histogram.h"
 
 namespace OHOS {
 
+enum class BlockQueueStatus {
+    OK,
+    TIMEOUT,  // the queue stayed full(push) or empty(pop) for the whole timeout
+    CLOSED,   // the queue was closed: a push is refused, a pop found nothing left to drain
+};
+
+struct BlockQueueStatistics {
+    Log2Histogram residence;  // ns from push to pop
+    Log2Histogram endToEnd;  // ns from push to OneTaskDone
+    Log2Histogram producerBlocked;  // ns a push waited for room, only pushes that did wait
+    size_t depthHighWater = 0;  // most elements queued at once
+};
+
+/*
+ * After Close(), pushes are refused and pops still return the elements left, so consumers can drain the queue.
+ * Blocked callers are woken: Push, Emplace and PushBatch return without pushing,
+ * Pop returns a default constructed T once the queue is empty, PopBatch returns 0.
+ * Use PushFor and PopFor to tell these cases apart.
+ */
 template <typename T>
 class SafeBlockQueue {
 public:
-    SafeBlockQueue(int capacity) : maxSize_(capacity)
+    SafeBlockQueue(int capacity) : maxSize_(capacity), closed_(false)
     {
     }
 
     virtual void Push(T const& elem)
     {
         std::unique_lock<std::mutex> lock(mutexLock_);
-        while (queueT_.size() >= maxSize_) {
-            // queue full , waiting for jobs to be taken
-            cvNotFull_.wait(lock, [&]() { return (queueT_.size() < maxSize_); });
+        // queue full , waiting for jobs to be taken
+        if (!WaitNotFull(lock)) {
+            return;
         }
 
         // here means not full we can push in
         queueT_.push(elem);
-        cvNotEmpty_.notify_one();
+        SignalNotEmpty();
+    }
+
+    virtual void Push(T&& elem)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotFull(lock)) {
+            return;
+        }
+        queueT_.push(std::move(elem));
+        SignalNotEmpty();
+    }
+
+    BlockQueueStatus PushFor(T const& elem, std::chrono::nanoseconds timeout)
+    {
+        T copied(elem);
+        return PushFor(std::move(copied), timeout);
+    }
+
+    // elem is left untouched unless the status is OK
+    BlockQueueStatus PushFor(T&& elem, std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotFullFor(lock, timeout)) {
+            return BlockQueueStatus::TIMEOUT;
+        }
+        if (closed_) {
+            return BlockQueueStatus::CLOSED;
+        }
+        queueT_.push(std::move(elem));
+        DoPushed(1);
+        SignalNotEmpty();
+        return BlockQueueStatus::OK;
+    }
+
+    // constructs the element in place, the arguments are evaluated before waiting for room
+    template <typename... Args>
+    void Emplace(Args&&... args)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotFull(lock)) {
+            return;
+        }
+        queueT_.emplace(std::forward<Args>(args)...);
+        DoPushed(1);
+        SignalNotEmpty();
     }
 
     T Pop()
     {
         std::unique_lock<std::mutex> lock(mutexLock_);
 
-        while (queueT_.empty()) {
-            // queue empty, waiting for tasks to be Push
-            cvNotEmpty_.wait(lock, [&] { return !queueT_.empty(); });
+        // queue empty, waiting for tasks to be Push
+        if (!WaitNotEmpty(lock)) {
+            return T();
         }
 
-        T elem = queueT_.front();
+        T elem = std::move(queueT_.front());
         queueT_.pop();
-        cvNotFull_.notify_one();
+        DoPopped(1);
+        SignalNotFull();
         return elem;
     }
 
+    BlockQueueStatus PopFor(T& outtask, std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotEmptyFor(lock, timeout)) {
+            return BlockQueueStatus::TIMEOUT;
+        }
+        if (queueT_.empty()) {
+            return BlockQueueStatus::CLOSED;
+        }
+        outtask = std::move(queueT_.front());
+        queueT_.pop();
+        DoPopped(1);
+        SignalNotFull();
+        return BlockQueueStatus::OK;
+    }
+
+    // refuses further pushes and wakes every blocked caller, elements already in the queue can still be popped
+    void Close()
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        closed_ = true;
+        cvNotFull_.notify_all();
+        cvNotEmpty_.notify_all();
+    }
+
+    bool IsClosed()
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        return closed_;
+    }
+
     virtual bool PushNoWait(T const& elem)
     {
         std::unique_lock<std::mutex> lock(mutexLock_);
-        if (queueT_.size() >= maxSize_) {
+        if (closed_ || (queueT_.size() >= maxSize_)) {
             return false;
         }
         // here means not full we can push in
         queueT_.push(elem);
-        cvNotEmpty_.notify_one();
+        SignalNotEmpty();
+        return true;
+    }
+
+    virtual bool PushNoWait(T&& elem)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (closed_ || (queueT_.size() >= maxSize_)) {
+            return false;
+        }
+        queueT_.push(std::move(elem));
+        SignalNotEmpty();
         return true;
     }
 
@@ -77,14 +192,79 @@ public:
         if (queueT_.empty()) {
             return false;
         }
-        outtask = queueT_.front();
+        outtask = std::move(queueT_.front());
         queueT_.pop();
+        DoPopped(1);
 
-        cvNotFull_.notify_one();
+        SignalNotFull();
 
         return true;
     }
 
+    /*
+     * Pushes every element of [first, last), blocking while the queue is full.
+     * Elements are pushed as room appears, each group under one lock, so a batch larger than the capacity
+     * does not wait for the whole batch to fit.
+     */
+    template <typename InputIterator>
+    void PushBatch(InputIterator first, InputIterator last)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        while (first != last) {
+            if (!WaitNotFull(lock)) {
+                return;
+            }
+            size_t pushed = 0;
+            for (; (first != last) && (queueT_.size() < maxSize_); ++first) {
+                queueT_.push(*first);
+                pushed++;
+            }
+            DoPushed(pushed);
+            SignalNotEmpty(pushed);
+        }
+    }
+
+    // blocks until the queue is not empty, then appends at most maxCount elements to out under one lock
+    size_t PopBatch(std::vector<T>& out, size_t maxCount)
+    {
+        if (maxCount == 0) {
+            return 0;
+        }
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotEmpty(lock)) {
+            return 0;
+        }
+        return PopBatchLocked(out, maxCount);
+    }
+
+    // same as PopBatch, but returns 0 at once if the queue is empty
+    size_t PopBatchNotWait(std::vector<T>& out, size_t maxCount)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        return PopBatchLocked(out, maxCount);
+    }
+
+    // takes all the elements without waiting, the container is swapped out, not copied, appends them to out
+    size_t DrainAll(std::queue<T>& out)
+    {
+        std::queue<T> drained;
+        {
+            std::unique_lock<std::mutex> lock(mutexLock_);
+            queueT_.swap(drained);
+            DoPopped(drained.size());
+            SignalNotFull(drained.size());
+        }
+        size_t count = drained.size();
+        if (out.empty()) {
+            out.swap(drained);
+            return count;
+        }
+        for (; !drained.empty(); drained.pop()) {
+            out.push(std::move(drained.front()));
+        }
+        return count;
+    }
+
     unsigned int Size()
     {
         std::unique_lock<std::mutex> lock(mutexLock_);
@@ -106,11 +286,117 @@ public:
     virtual ~SafeBlockQueue() {}
 
 protected:
+    // called with the lock held after PushBatch, Emplace or PushFor added count elements
+    virtual void DoPushed(size_t) {}
+    // called with the lock held after count elements were taken from the front
+    virtual void DoPopped(size_t) {}
+    // called with the lock held after a push waited for room
+    virtual void DoBlockedNotFull(std::chrono::nanoseconds) {}
+
+    /*
+     * Waiters are counted, so that pushes and pops only signal a condition variable when a thread is parked on it.
+     * In the common case of a queue neither empty nor full, no thread ever waits and no signal is sent.
+     */
+
+    // returns false if the queue is closed
+    bool WaitNotFull(std::unique_lock<std::mutex>& lock)
+    {
+        auto ready = [&]() { return closed_ || (queueT_.size() < maxSize_); };
+        if (!ready()) {
+            auto begin = std::chrono::steady_clock::now();
+            notFullWaiters_++;
+            cvNotFull_.wait(lock, ready);
+            notFullWaiters_--;
+            DoBlockedNotFull(std::chrono::steady_clock::now() - begin);
+        }
+        return !closed_;
+    }
+
+    // returns false if the queue is closed and drained
+    bool WaitNotEmpty(std::unique_lock<std::mutex>& lock)
+    {
+        auto ready = [&] { return closed_ || !queueT_.empty(); };
+        if (!ready()) {
+            notEmptyWaiters_++;
+            cvNotEmpty_.wait(lock, ready);
+            notEmptyWaiters_--;
+        }
+        return !queueT_.empty();
+    }
+
+    // returns false on timeout, the queue may be closed otherwise
+    bool WaitNotFullFor(std::unique_lock<std::mutex>& lock, std::chrono::nanoseconds timeout)
+    {
+        auto ready = [&]() { return closed_ || (queueT_.size() < maxSize_); };
+        if (ready()) {
+            return true;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        notFullWaiters_++;
+        bool ret = cvNotFull_.wait_for(lock, timeout, ready);
+        notFullWaiters_--;
+        DoBlockedNotFull(std::chrono::steady_clock::now() - begin);
+        return ret;
+    }
+
+    // returns false on timeout, the queue may be closed otherwise
+    bool WaitNotEmptyFor(std::unique_lock<std::mutex>& lock, std::chrono::nanoseconds timeout)
+    {
+        auto ready = [&] { return closed_ || !queueT_.empty(); };
+        if (ready()) {
+            return true;
+        }
+        notEmptyWaiters_++;
+        bool ret = cvNotEmpty_.wait_for(lock, timeout, ready);
+        notEmptyWaiters_--;
+        return ret;
+    }
+
+    // the lock must be held, count elements were pushed
+    void SignalNotEmpty(size_t count = 1)
+    {
+        NotifyFor(cvNotEmpty_, notEmptyWaiters_, count);
+    }
+
+    // the lock must be held, count elements were popped
+    void SignalNotFull(size_t count = 1)
+    {
+        NotifyFor(cvNotFull_, notFullWaiters_, count);
+    }
+
+    // one waiter is enough for one element, a batch may feed them all
+    static void NotifyFor(std::condition_variable& cv, size_t waiters, size_t count)
+    {
+        if ((waiters == 0) || (count == 0)) {
+            return;
+        }
+        if ((count == 1) || (waiters == 1)) {
+            cv.notify_one();
+        } else {
+            cv.notify_all();
+        }
+    }
+
+    size_t PopBatchLocked(std::vector<T>& out, size_t maxCount)
+    {
+        size_t count = 0;
+        for (; (count < maxCount) && !queueT_.empty(); count++) {
+            out.push_back(std::move(queueT_.front()));
+            queueT_.pop();
+        }
+        DoPopped(count);
+        SignalNotFull(count);
+        return count;
+    }
+
     unsigned long maxSize_;
     std::mutex mutexLock_;
     std::condition_variable cvNotEmpty_;
     std::condition_variable cvNotFull_;
     std::queue<T> queueT_;
+    bool closed_;
+    size_t notFullWaiters_ = 0;
+    size_t notEmptyWaiters_ = 0;
 };
 
 template <typename T>
@@ -127,27 +413,56 @@ public:
     {
         unfinishedTaskCount_++;
         std::unique_lock<std::mutex> lock(mutexLock_);
-        while (queueT_.size() >= maxSize_) {
-            // queue full , waiting for jobs to be taken
-            cvNotFull_.wait(lock, [&]() { return (queueT_.size() < maxSize_); });
+        // queue full , waiting for jobs to be taken
+        if (!WaitNotFull(lock)) {
+            RefusedTask();
+            return;
         }
 
         // here means not full we can push in
         queueT_.push(elem);
+        StampPushed(1);
 
-        cvNotEmpty_.notify_one();
+        SignalNotEmpty();
+    }
+
+    virtual void Push(T&& elem)
+    {
+        unfinishedTaskCount_++;
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (!WaitNotFull(lock)) {
+            RefusedTask();
+            return;
+        }
+        queueT_.push(std::move(elem));
+        StampPushed(1);
+        SignalNotEmpty();
     }
 
     virtual bool PushNoWait(T const& elem)
     {
         std::unique_lock<std::mutex> lock(mutexLock_);
-        if (queueT_.size() >= maxSize_) {
+        if (closed_ || (queueT_.size() >= maxSize_)) {
             return false;
         }
         // here means not full we can push in
         queueT_.push(elem);
         unfinishedTaskCount_++;
-        cvNotEmpty_.notify_one();
+        StampPushed(1);
+        SignalNotEmpty();
+        return true;
+    }
+
+    virtual bool PushNoWait(T&& elem)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (closed_ || (queueT_.size() >= maxSize_)) {
+            return false;
+        }
+        queueT_.push(std::move(elem));
+        unfinishedTaskCount_++;
+        StampPushed(1);
+        SignalNotEmpty();
         return true;
     }
 
@@ -164,6 +479,10 @@ public:
         }
 
         unfinishedTaskCount_ = unfinished;
+        if (statisticsEnabled_ && !inFlightTimes_.empty()) {
+            RecordSince(statistics_.endToEnd, inFlightTimes_.front());
+            inFlightTimes_.pop_front();
+        }
         return true;
     }
 
@@ -178,15 +497,119 @@ public:
         return unfinishedTaskCount_;
     }
 
+    /*
+     * Statistics cost a clock read per push, pop and OneTaskDone, so they are off by default.
+     * OneTaskDone does not tell which task is done, end-to-end latency is measured for the oldest task popped
+     * and not done yet: exact with one consumer, an approximation when several consumers finish out of order.
+     * Tasks already queued or in flight when statistics are enabled are not measured.
+     */
+    void EnableStatistics(bool enable)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        if (enable == statisticsEnabled_) {
+            return;
+        }
+        statisticsEnabled_ = enable;
+        if (enable) {
+            // keep one time per queued and in flight task, 0 means unknown
+            size_t queued = queueT_.size();
+            int inFlight = unfinishedTaskCount_ - static_cast<int>(queued);
+            enqueueTimes_.assign(queued, 0);
+            inFlightTimes_.assign(inFlight > 0 ? inFlight : 0, 0);
+        } else {
+            enqueueTimes_.clear();
+            inFlightTimes_.clear();
+        }
+    }
+
+    BlockQueueStatistics GetStatistics()
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        return statistics_;
+    }
+
+    void ResetStatistics()
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        statistics_ = BlockQueueStatistics();
+    }
+
 protected:
+    virtual void DoPushed(size_t count) override
+    {
+        unfinishedTaskCount_ += static_cast<int>(count);
+        StampPushed(count);
+    }
+
+    virtual void DoPopped(size_t count) override
+    {
+        if (!statisticsEnabled_) {
+            return;
+        }
+        for (size_t i = 0; (i < count) && !enqueueTimes_.empty(); i++) {
+            uint64_t enqueueTime = enqueueTimes_.front();
+            enqueueTimes_.pop_front();
+            RecordSince(statistics_.residence, enqueueTime);
+            inFlightTimes_.push_back(enqueueTime);
+        }
+    }
+
+    virtual void DoBlockedNotFull(std::chrono::nanoseconds blocked) override
+    {
+        if (statisticsEnabled_) {
+            statistics_.producerBlocked.Add(static_cast<uint64_t>(blocked.count()));
+        }
+    }
+
+    static uint64_t NowNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void RecordSince(Log2Histogram& histogram, uint64_t since)
+    {
+        if (since != 0) {
+            uint64_t now = NowNs();
+            histogram.Add(now > since ? now - since : 0);
+        }
+    }
+
+    // the lock must be held, count elements were just pushed
+    void StampPushed(size_t count)
+    {
+        if (!statisticsEnabled_) {
+            return;
+        }
+        enqueueTimes_.insert(enqueueTimes_.end(), count, NowNs());
+        if (queueT_.size() > statistics_.depthHighWater) {
+            statistics_.depthHighWater = queueT_.size();
+        }
+    }
+
+    // a closed queue refused a task counted before waiting, the lock must be held
+    void RefusedTask()
+    {
+        if (--unfinishedTaskCount_ == 0) {
+            cvAllTasksDone_.notify_all();
+        }
+    }
+
     using SafeBlockQueue<T>::maxSize_;
     using SafeBlockQueue<T>::mutexLock_;
     using SafeBlockQueue<T>::cvNotEmpty_;
     using SafeBlockQueue<T>::cvNotFull_;
     using SafeBlockQueue<T>::queueT_;
+    using SafeBlockQueue<T>::closed_;
+    using SafeBlockQueue<T>::WaitNotFull;
+    using SafeBlockQueue<T>::SignalNotEmpty;
 
     std::atomic<int> unfinishedTaskCount_;
     std::condition_variable cvAllTasksDone_;
+    bool statisticsEnabled_ = false;
+    std::deque<uint64_t> enqueueTimes_;  // one per queued task, in queue order
+    std::deque<uint64_t> inFlightTimes_;  // one per task popped and not done yet, in pop order
+    BlockQueueStatistics statistics_;
 };
 
 } // namespace OHOS
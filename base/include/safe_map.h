@@ -16,8 +16,10 @@
 #ifndef UTILS_BASE_SAFE_MAP_H
 #define UTILS_BASE_SAFE_MAP_H
 
+#include <cstddef>
 #include <map>
 #include <mutex>
+#include <utility>
 
 namespace OHOS {
 
@@ -68,19 +70,40 @@ public:
         return ret.second;
     }
 
+    bool Insert(K&& key, V&& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = map_.lower_bound(key);
+        // key and value are left untouched if key exists
+        if ((iter != map_.end()) && !map_.key_comp()(key, iter->first)) {
+            return false;
+        }
+        map_.emplace_hint(iter, std::move(key), std::move(value));
+        return true;
+    }
+
     void EnsureInsert(const K& key, const V& value)
     {
         std::lock_guard<std::mutex> lock(mutex_);
         auto ret = map_.insert(std::pair<K, V>(key, value));
         // find key and cannot insert
         if (!ret.second) {
-            map_.erase(ret.first);
-            map_.insert(std::pair<K, V>(key, value));
-            return;
+            ret.first->second = value;
         }
         return;
     }
 
+    void EnsureInsert(K&& key, V&& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = map_.lower_bound(key);
+        if ((iter != map_.end()) && !map_.key_comp()(key, iter->first)) {
+            iter->second = std::move(value);
+            return;
+        }
+        map_.emplace_hint(iter, std::move(key), std::move(value));
+    }
+
     bool Find(const K& key, V& value)
     {
         bool ret = false;
@@ -103,8 +126,7 @@ public:
             auto iter = map_.find(key);
             if (iter != map_.end()) {
                 oldValue = iter->second;
-                map_.erase(iter);
-                map_.insert(std::pair<K, V>(key, newValue));
+                iter->second = newValue;
                 ret = true;
             }
         }
@@ -112,6 +134,92 @@ public:
         return ret;
     }
 
+    /*
+     * The callbacks below run with the map locked, so they must not call back into this map.
+     * They read or change values in place, without copying them out.
+     */
+
+    // calls visitor(const V&) on the value of key, returns false if key does not exist
+    template <typename Visitor>
+    bool FindAndApply(const K& key, Visitor&& visitor)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = map_.find(key);
+        if (iter == map_.end()) {
+            return false;
+        }
+        const V& value = iter->second;
+        visitor(value);
+        return true;
+    }
+
+    // calls updater(V&) on the value of key, returns false if key does not exist
+    template <typename Updater>
+    bool UpdateInPlace(const K& key, Updater&& updater)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = map_.find(key);
+        if (iter == map_.end()) {
+            return false;
+        }
+        updater(iter->second);
+        return true;
+    }
+
+    // inserts the value returned by creator() if key does not exist, returns whether it was inserted
+    template <typename Creator>
+    bool ComputeIfAbsent(const K& key, Creator&& creator)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = map_.lower_bound(key);
+        if ((iter != map_.end()) && !map_.key_comp()(key, iter->first)) {
+            return false;
+        }
+        map_.emplace_hint(iter, key, creator());
+        return true;
+    }
+
+    // calls visitor(const K&, V&) on every entry in key order
+    template <typename Visitor>
+    void Iterate(Visitor&& visitor)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : map_) {
+            visitor(entry.first, entry.second);
+        }
+    }
+
+    // inserts every pair in [first, last) whose key does not exist yet, under one lock, returns the count inserted
+    template <typename InputIterator>
+    size_t InsertAll(InputIterator first, InputIterator last)
+    {
+        size_t inserted = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (; first != last; ++first) {
+            if (map_.insert(*first).second) {
+                inserted++;
+            }
+        }
+        return inserted;
+    }
+
+    // erases every entry for which predicate(const K&, const V&) returns true, returns the count erased
+    template <typename Predicate>
+    size_t EraseIf(Predicate&& predicate)
+    {
+        size_t erased = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto iter = map_.begin(); iter != map_.end();) {
+            if (predicate(iter->first, static_cast<const V&>(iter->second))) {
+                iter = map_.erase(iter);
+                erased++;
+            } else {
+                ++iter;
+            }
+        }
+        return erased;
+    }
+
     void Erase(const K& key)
     {
         std::lock_guard<std::mutex> lock(mutex_);
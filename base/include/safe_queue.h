@@ -16,8 +16,13 @@
 #ifndef UTILS_BASE_SAFE_QUEUE_H
 #define UTILS_BASE_SAFE_QUEUE_H
 
+#include <algorithm>
+#include <cstddef>
 #include <deque>
+#include <iterator>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace OHOS {
 
@@ -52,6 +57,21 @@ public:
         return DoPush(pt);
     }
 
+    void Push(T&& pt)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return DoPush(std::move(pt));
+    }
+
+    // the element is constructed before taking the lock, then moved in
+    template <typename... Args>
+    void Emplace(Args&&... args)
+    {
+        T pt(std::forward<Args>(args)...);
+        std::lock_guard<std::mutex> lock(mutex_);
+        DoPush(std::move(pt));
+    }
+
     void Clear()
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -74,9 +94,57 @@ public:
         return DoPop(pt);
     }
 
+    // pushes every element of [first, last) under one lock
+    template <typename InputIterator>
+    void PushBatch(InputIterator first, InputIterator last)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (; first != last; ++first) {
+            DoPush(*first);
+        }
+    }
+
+    // appends at most maxCount elements to out in the order Pop returns them, under one lock
+    size_t PopBatch(std::vector<T>& out, size_t maxCount)
+    {
+        size_t count = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        T pt;
+        while ((count < maxCount) && DoPop(pt)) {
+            out.push_back(std::move(pt));
+            count++;
+        }
+        return count;
+    }
+
+    // takes all the elements at once, the container is swapped out, not copied, appends them to out in Pop order
+    size_t DrainAll(std::deque<T>& out)
+    {
+        std::deque<T> drained;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            deque_.swap(drained);
+        }
+        DoOrderDrained(drained);
+        size_t count = drained.size();
+        if (out.empty()) {
+            out.swap(drained);
+        } else {
+            std::move(drained.begin(), drained.end(), std::back_inserter(out));
+        }
+        return count;
+    }
+
 protected:
     virtual void DoPush(const T& pt) = 0;
+    // copies by default, so that existing subclasses keep working
+    virtual void DoPush(T&& pt)
+    {
+        DoPush(static_cast<const T&>(pt));
+    }
     virtual bool DoPop(T& pt) = 0;
+    // called without the lock on what DrainAll took, to put it in Pop order
+    virtual void DoOrderDrained(std::deque<T>&) {}
 
     std::deque<T> deque_;
     std::mutex mutex_;
@@ -94,10 +162,15 @@ protected:
         deque_.push_back(pt);
     }
 
+    virtual void DoPush(T&& pt) override
+    {
+        deque_.push_back(std::move(pt));
+    }
+
     virtual bool DoPop(T& pt) override
     {
         if (deque_.size() > 0) {
-            pt = deque_.front();
+            pt = std::move(deque_.front());
             deque_.pop_front();
             return true;
         }
@@ -118,16 +191,26 @@ protected:
         deque_.push_back(pt);
     }
 
+    virtual void DoPush(T&& pt) override
+    {
+        deque_.push_back(std::move(pt));
+    }
+
     virtual bool DoPop(T& pt) override
     {
         if (deque_.size() > 0) {
-            pt = deque_.back();
+            pt = std::move(deque_.back());
             deque_.pop_back();
             return true;
         }
 
         return false;
     }
+
+    virtual void DoOrderDrained(std::deque<T>& drained) override
+    {
+        std::reverse(drained.begin(), drained.end());
+    }
 };
 
 } // namespace OHOS
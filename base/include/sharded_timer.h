@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_SHARDED_TIMER_H
+#define UTILS_SHARDED_TIMER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "timer.h"
+
+namespace OHOS {
+namespace Utils {
+
+/*
+ * ShardedTimer spreads timers over several Timer instances, each with its own loop thread and lock,
+ * so that registration from many threads does not contend on one mutex and callbacks run on several cores.
+ * Callbacks of timers in different shards may run concurrently.
+ * Timer ids returned are unique within the ShardedTimer, whatever shard the timer lives in.
+ */
+class ShardedTimer {
+public:
+    using TimerCallback = Timer::TimerCallback;
+
+    enum class ShardPolicy {
+        ROUND_ROBIN,    // spread timers evenly, lock-free pick
+        CALLER_THREAD,  // timers registered by one thread share a shard, its callbacks never run concurrently
+    };
+
+    /*
+     * shards: number of Timer instances(loop threads), 0 means std::thread::hardware_concurrency()
+     * timeoutMs, clockId: see Timer
+     */
+    explicit ShardedTimer(const std::string& name, uint32_t shards = 0, ShardPolicy policy = ShardPolicy::ROUND_ROBIN,
+        int timeoutMs = -1, clockid_t clockId = CLOCK_MONOTONIC);
+    virtual ~ShardedTimer() {}
+
+    ShardedTimer(const ShardedTimer&) = delete;
+    ShardedTimer& operator=(const ShardedTimer&) = delete;
+
+    uint32_t Setup();
+    void Shutdown(bool useJoin = true);
+
+    uint32_t Register(const TimerCallback& callback, uint32_t interval /* ms */, bool once = false);
+    uint32_t Register(const TimerCallback& callback, std::chrono::nanoseconds interval, bool once = false);
+    uint32_t RegisterAt(const TimerCallback& callback, std::chrono::nanoseconds deadline,
+        std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero());
+    uint32_t RegisterWithSlack(const TimerCallback& callback, std::chrono::nanoseconds interval,
+        std::chrono::nanoseconds slack, bool once = false);
+    void Unregister(uint32_t timerId);
+
+    uint32_t GetShardCount() const { return static_cast<uint32_t>(shards_.size()); }
+    std::chrono::nanoseconds Now() const { return shards_[0]->Now(); }
+
+private:
+    using ShardRegister = std::function<uint32_t (Timer& shard, const TimerCallback& callback)>;
+
+    struct TimerLocation {
+        uint32_t shard;
+        uint32_t localId;  // id inside the shard, 0 until the shard has registered it
+    };
+
+    // ids are spread over stripes, registration in different stripes never contends
+    struct IdStripe {
+        std::mutex mutex;
+        std::unordered_map<uint32_t, TimerLocation> locations;
+    };
+
+    static constexpr uint32_t ID_STRIPES = 64;
+
+    uint32_t DoRegister(const TimerCallback& callback, bool once, const ShardRegister& shardRegister);
+    uint32_t PickShard();
+    uint32_t ReserveId(uint32_t shard);
+    bool EraseId(uint32_t timerId, TimerLocation& location);
+    IdStripe& GetStripe(uint32_t timerId) { return stripes_[timerId % ID_STRIPES]; }
+
+    std::string name_;
+    ShardPolicy policy_;
+    std::vector<std::unique_ptr<Timer>> shards_;
+    std::atomic<uint32_t> nextShard_;
+    std::atomic<uint32_t> nextId_;
+    std::array<IdStripe, ID_STRIPES> stripes_;
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
@@ -17,9 +17,14 @@
 #define UTILS_BASE_SORTED_VECTOR_H
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <sys/types.h>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace OHOS {
@@ -48,13 +53,19 @@ public:
     SortedVector<TYPE, AllowDuplicate>& operator=(const SortedVector<TYPE, false>& rhs);
     SortedVector<TYPE, AllowDuplicate>& operator=(const SortedVector<TYPE, true>& rhs);
 
-    inline void Clear() { vec_.clear(); }
+    inline void Clear()
+    {
+        vec_.clear();
+        staged_.clear();
+        ItemsChanged();
+    }
     inline size_t Size() const { return vec_.size(); }
     inline bool IsEmpty() const { return vec_.empty(); }
     inline size_t Capacity() const { return vec_.capacity(); }
 
     ssize_t SetCapcity(size_t size)
     {
+        Flush();
         if (size < vec_.capacity()) {
             return CAPCITY_NOT_CHANGED;
         }
@@ -66,7 +77,12 @@ public:
     // Cstyle access
     // when use it , you should make sure it sorted~!
     inline const TYPE* Array() const { return vec_.data(); }
-    TYPE* EditArray() { return vec_.data(); }
+    TYPE* EditArray()
+    {
+        Flush();
+        indexStale_ = true;
+        return vec_.data();
+    }
 
     ssize_t IndexOf(const TYPE& item) const;
     size_t OrderOf(const TYPE& item) const;
@@ -76,7 +92,12 @@ public:
 
     const TYPE& Back() const { return vec_.back(); }
     const TYPE& Front() const { return vec_.front(); }
-    void PopBack() { return vec_.pop_back(); }
+    void PopBack()
+    {
+        Flush();
+        vec_.pop_back();
+        ItemsChanged();
+    }
 
     const TYPE& MirrorItemAt(ssize_t index) const
     {
@@ -90,24 +111,82 @@ public:
     ssize_t Add(const TYPE& item);
     TYPE& EditItemAt(size_t index)
     {
+        Flush();
+        indexStale_ = true;
         return vec_[index];
     }
 
-    // merge a vector into this one
+    /*
+     * Deferred adds for bulk loading: items are appended to an unsorted staging buffer,
+     * which is sorted and merged in one go by EndBatch() or by the next non-const call.
+     * N deferred adds cost O(N log N) in total instead of one O(n) shift each.
+     * Const calls never merge, so that several threads can still read a const vector: until the merge they,
+     * and copies or merges from a const vector, see only the items merged before. DeferredSize() tells what is left.
+     * BeginBatch reserves room for the expected number of items, so the staging buffer is allocated once.
+     */
+    void BeginBatch(size_t expected = 0) { staged_.reserve(staged_.size() + expected); }
+    void AddDeferred(const TYPE& item) { staged_.push_back(item); }
+    void AddDeferred(TYPE&& item) { staged_.push_back(std::move(item)); }
+    size_t EndBatch()
+    {
+        Flush();
+        return vec_.size();
+    }
+    inline size_t DeferredSize() const { return staged_.size(); }
+
+    /*
+     * Search index for large vectors of arithmetic items, used by IndexOf and OrderOf instead of a binary search.
+     * Every CACHE_LINE / sizeof(TYPE)-th item is copied into a shadow array in Eytzinger (breadth first) order,
+     * where the children of a node follow each other and are prefetched while the node is compared.
+     * The search in the shadow array ends on one cache line of the vector, which is scanned linearly.
+     * The index takes about (sizeof(TYPE) + sizeof(size_t)) / BLOCK bytes per item. It is rebuilt in O(n / BLOCK)
+     * by each non-const call that changes the items and never by a search, so several threads can search at once.
+     * EditArray, EditItemAt and non-const iterators hand out items to be written later, so after them searches
+     * fall back to a binary search until the next change or SetSearchIndex(true) rebuilds the index.
+     * Writes through such a pointer, reference or iterator after that rebuild are not seen by the index,
+     * so none of them may be kept across it.
+     */
+    void SetSearchIndex(bool enable)
+    {
+        static_assert(std::is_arithmetic<TYPE>::value, "the search index is for arithmetic types");
+        Flush();
+        useIndex_ = enable;
+        if (enable) {
+            BuildIndex();
+            return;
+        }
+        indexStale_ = true;
+        std::vector<TYPE>().swap(eytzinger_);
+        std::vector<size_t>().swap(eytzingerRank_);
+    }
+    inline bool HasSearchIndex() const { return useIndex_; }
+
+    // merge a vector into this one, in place from the back; the rvalue overloads move the items in
     size_t Merge(const std::vector<TYPE>& invec);
+    size_t Merge(std::vector<TYPE>&& invec);
     size_t Merge(const SortedVector<TYPE, AllowDuplicate>& sortedVector);
+    size_t Merge(SortedVector<TYPE, AllowDuplicate>&& sortedVector);
+
+    // merge in threadNum threads into a new array, only worth it for millions of items;
+    // TYPE must be default constructible
+    size_t ParallelMerge(const SortedVector<TYPE, AllowDuplicate>& sortedVector, size_t threadNum);
 
     // erase an item at index
     iterator Erase(size_t index)
     {
+        Flush();
         if (index >= vec_.size()) {
             return vec_.end();
         }
-        return vec_.erase(vec_.begin() + index);
+        iterator next = vec_.erase(vec_.begin() + index);
+        ItemsChanged();
+        return next;
     }
 
     iterator Begin()
     {
+        Flush();
+        indexStale_ = true;
         return vec_.begin();
     }
 
@@ -118,6 +197,8 @@ public:
 
     iterator End()
     {
+        Flush();
+        indexStale_ = true;
         return vec_.end();
     }
 
@@ -131,7 +212,58 @@ public:
     static const ssize_t CAPCITY_NOT_CHANGED = -1;
 
 private:
+    // merges the sorted range [first, last) into vec_, which grows once and is filled from the back
+    template <class Iter>
+    void MergeFromBack(Iter first, Iter last);
+
+    // slots to be overwritten by MergeFromBack
+    void Grow(size_t count, std::true_type) { vec_.resize(vec_.size() + count); }
+    void Grow(size_t count, std::false_type)
+    {
+        TYPE filler(vec_.back());
+        vec_.resize(vec_.size() + count, filler);
+    }
+
+    // items of head among the first pos items of the merge of head and tail, equal items from head first
+    static size_t CoRank(size_t pos, const std::vector<TYPE>& head, const std::vector<TYPE>& tail);
+
+    // merges the deferred adds
+    inline void Flush()
+    {
+        if (!staged_.empty()) {
+            MergeStaged();
+        }
+    }
+    void MergeStaged();
+
+    // items per block scanned at the end of an indexed search, one cache line
+    static constexpr size_t BLOCK = (64 / sizeof(TYPE) > 1) ? (64 / sizeof(TYPE)) : 1;
+    // the descendants of node k log2(BLOCK) levels below start at k * BLOCK and share one cache line
+    static constexpr size_t PREFETCH_STRIDE = BLOCK;
+
+    void BuildIndex();
+    size_t BuildIndex(size_t node, size_t sample);
+    // the items changed through a call that hands out nothing to write later, so the index can follow at once;
+    // only arithmetic items can have an index
+    void ItemsChanged() { ItemsChanged(std::is_arithmetic<TYPE>()); }
+    void ItemsChanged(std::true_type)
+    {
+        if (useIndex_) {
+            BuildIndex();
+        }
+    }
+    void ItemsChanged(std::false_type) {}
+    // first index whose item is not before(item, x), with before being operator< or operator<=
+    template <class Before>
+    size_t IndexedBound(const TYPE& item, Before before) const;
+
     std::vector<TYPE> vec_;
+    std::vector<TYPE> staged_;
+
+    bool useIndex_ = false;
+    bool indexStale_ = true;  // items may have been written through EditArray, EditItemAt or a non-const iterator
+    std::vector<TYPE> eytzinger_;  // every BLOCK-th item in Eytzinger order, 1-based
+    std::vector<size_t> eytzingerRank_;  // block of each node of eytzinger_
 };
 
 template <class TYPE, bool AllowDuplicate>
@@ -162,8 +294,9 @@ template <class TYPE, bool AllowDuplicate>
 SortedVector<TYPE, AllowDuplicate>& SortedVector<TYPE, AllowDuplicate>::operator=(const SortedVector<TYPE, false>& rhs)
 {
     // this class: AllowDuplicate or Not AllowDuplicate same type
-    vec_.clear();
+    Clear();
     std::copy(rhs.Begin(), rhs.End(), std::back_inserter(vec_));
+    ItemsChanged();
     return *this;
 }
 
@@ -171,7 +304,7 @@ SortedVector<TYPE, AllowDuplicate>& SortedVector<TYPE, AllowDuplicate>::operator
 template <class TYPE, bool AllowDuplicate>
 SortedVector<TYPE, AllowDuplicate>& SortedVector<TYPE, AllowDuplicate>::operator=(const SortedVector<TYPE, true>& rhs)
 {
-    vec_.clear();
+    Clear();
 
     if (AllowDuplicate) {
         std::copy(rhs.Begin(), rhs.End(), std::back_inserter(vec_));
@@ -179,6 +312,7 @@ SortedVector<TYPE, AllowDuplicate>& SortedVector<TYPE, AllowDuplicate>::operator
         // AllowDuplicate to Not AllowDuplicate
         std::unique_copy(rhs.Begin(), rhs.End(), std::back_inserter(vec_));
     }
+    ItemsChanged();
 
     return *this;
 }
@@ -190,6 +324,13 @@ ssize_t SortedVector<TYPE, AllowDuplicate>::IndexOf(const TYPE& item) const
         return NOT_FOUND;
     }
 
+    if (useIndex_ && !indexStale_) {
+        size_t index = IndexedBound(item, std::less<TYPE>());
+        if (index == vec_.size() || !(vec_[index] == item)) {
+            return NOT_FOUND;
+        }
+        return index;
+    }
     auto it = std::lower_bound(std::begin(vec_), std::end(vec_), item);
     if (it == vec_.end() || !(*it == item)) {
         return NOT_FOUND;
@@ -200,6 +341,9 @@ ssize_t SortedVector<TYPE, AllowDuplicate>::IndexOf(const TYPE& item) const
 template <class TYPE, bool AllowDuplicate>
 size_t SortedVector<TYPE, AllowDuplicate>::OrderOf(const TYPE& item) const
 {
+    if (useIndex_ && !indexStale_ && !vec_.empty()) {
+        return IndexedBound(item, std::less_equal<TYPE>());
+    }
     auto it = std::upper_bound(vec_.begin(), vec_.end(), item);
     return it - vec_.begin();
 }
@@ -207,13 +351,18 @@ size_t SortedVector<TYPE, AllowDuplicate>::OrderOf(const TYPE& item) const
 template <class TYPE, bool AllowDuplicate>
 ssize_t SortedVector<TYPE, AllowDuplicate>::Add(const TYPE& item)
 {
-    ssize_t index = IndexOf(item);
-    if (index != NOT_FOUND && !AllowDuplicate) {
-        return ADD_FAIL;
+    Flush();
+    // a plain search, IndexOf would rebuild a stale index right before the insert makes it stale again
+    if (!AllowDuplicate) {
+        auto lower = std::lower_bound(vec_.begin(), vec_.end(), item);
+        if (lower != vec_.end() && *lower == item) {
+            return ADD_FAIL;
+        }
     }
 
     auto it = std::upper_bound(vec_.begin(), vec_.end(), item);
     it = vec_.insert(it, item);
+    ItemsChanged();
     return it - vec_.begin();
 }
 
@@ -233,25 +382,218 @@ SortedVector<TYPE, AllowDuplicate>::SortedVector(const std::vector<TYPE>& invec)
     }
 }
 
+template <class TYPE, bool AllowDuplicate>
+template <class Iter>
+void SortedVector<TYPE, AllowDuplicate>::MergeFromBack(Iter first, Iter last)
+{
+    size_t i = vec_.size();  // items of vec_ left
+    size_t j = std::distance(first, last);  // items of [first, last) left
+    if (j == 0) {
+        return;
+    }
+    if (i == 0) {
+        vec_.assign(first, last);
+        return;
+    }
+    Grow(j, std::is_default_constructible<TYPE>());
+
+    // out never reaches the items of vec_ left, so nothing is overwritten before it is read
+    size_t out = vec_.size();
+    while ((i > 0) && (j > 0)) {
+        Iter tail = std::next(first, j - 1);
+        if (*tail < vec_[i - 1]) {
+            vec_[--out] = std::move(vec_[--i]);
+            continue;
+        }
+        if (!AllowDuplicate && !(vec_[i - 1] < *tail)) {
+            i--;  // equal, keeps only the one from [first, last)
+        }
+        vec_[--out] = *tail;
+        j--;
+    }
+    while (j > 0) {
+        vec_[--out] = *std::next(first, --j);
+    }
+    if (out != i) {
+        std::move_backward(vec_.begin(), vec_.begin() + i, vec_.begin() + out);
+    }
+    out -= i;
+
+    // dropped duplicates left out slots unused at the front
+    if (out > 0) {
+        std::move(vec_.begin() + out, vec_.end(), vec_.begin());
+        vec_.erase(vec_.end() - out, vec_.end());
+    }
+}
+
 template <class TYPE, bool AllowDuplicate>
 size_t SortedVector<TYPE, AllowDuplicate>::Merge(const std::vector<TYPE>& invec)
 {
-    SortedVector<TYPE, AllowDuplicate> sortedVector(invec);
-    Merge(sortedVector);
+    std::vector<TYPE> sorted(invec);
+    return Merge(std::move(sorted));
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t SortedVector<TYPE, AllowDuplicate>::Merge(std::vector<TYPE>&& invec)
+{
+    Flush();
+    std::sort(invec.begin(), invec.end());
+    if (!AllowDuplicate) {
+        invec.erase(std::unique(invec.begin(), invec.end()), invec.end());
+    }
+    if (vec_.empty()) {
+        vec_.swap(invec);
+    } else {
+        MergeFromBack(std::make_move_iterator(invec.begin()), std::make_move_iterator(invec.end()));
+    }
+    invec.clear();
+    ItemsChanged();
     return vec_.size();
 }
 
 template <class TYPE, bool AllowDuplicate>
 size_t SortedVector<TYPE, AllowDuplicate>::Merge(const SortedVector<TYPE, AllowDuplicate>& sortedVector)
 {
-    std::vector<TYPE> newVec;
-    std::merge(vec_.begin(), vec_.end(), sortedVector.Begin(), sortedVector.End(), std::back_inserter(newVec));
+    Flush();
+    if (&sortedVector == this) {
+        SortedVector<TYPE, AllowDuplicate> copy(sortedVector);
+        return Merge(std::move(copy));
+    }
+    MergeFromBack(sortedVector.vec_.begin(), sortedVector.vec_.end());
+    ItemsChanged();
+    return vec_.size();
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t SortedVector<TYPE, AllowDuplicate>::Merge(SortedVector<TYPE, AllowDuplicate>&& sortedVector)
+{
+    if (&sortedVector == this) {
+        return Merge(static_cast<const SortedVector<TYPE, AllowDuplicate>&>(sortedVector));
+    }
+    Flush();
+    sortedVector.Flush();
+    MergeFromBack(std::make_move_iterator(sortedVector.vec_.begin()), std::make_move_iterator(sortedVector.vec_.end()));
+    sortedVector.vec_.clear();
+    ItemsChanged();
+    return vec_.size();
+}
+
+template <class TYPE, bool AllowDuplicate>
+void SortedVector<TYPE, AllowDuplicate>::MergeStaged()
+{
+    std::vector<TYPE> staged;
+    staged.swap(staged_);
+    Merge(std::move(staged));
+}
+
+template <class TYPE, bool AllowDuplicate>
+void SortedVector<TYPE, AllowDuplicate>::BuildIndex()
+{
+    size_t samples = (vec_.size() + BLOCK - 1) / BLOCK;
+    eytzinger_.resize(samples + 1);
+    eytzingerRank_.resize(samples + 1);
+    BuildIndex(1, 0);
+    indexStale_ = false;
+}
+
+// in-order walk of the implicit tree, so the samples land in sorted order
+template <class TYPE, bool AllowDuplicate>
+size_t SortedVector<TYPE, AllowDuplicate>::BuildIndex(size_t node, size_t sample)
+{
+    if (node >= eytzinger_.size()) {
+        return sample;
+    }
+    sample = BuildIndex(node * 2, sample);
+    eytzinger_[node] = vec_[sample * BLOCK];
+    eytzingerRank_[node] = sample;
+    return BuildIndex(node * 2 + 1, sample + 1);
+}
+
+template <class TYPE, bool AllowDuplicate>
+template <class Before>
+size_t SortedVector<TYPE, AllowDuplicate>::IndexedBound(const TYPE& item, Before before) const
+{
+    // first sample not before item, node 0 if every sample is
+    size_t samples = eytzinger_.size() - 1;
+    size_t node = 1;
+    while (node <= samples) {
+#if defined(__GNUC__) || defined(__clang__)
+        // past the last level the descendants do not exist, the address is clamped to stay inside the array
+        __builtin_prefetch(eytzinger_.data() + std::min(node * PREFETCH_STRIDE, samples));
+#endif
+        node = node * 2 + (before(eytzinger_[node], item) ? 1 : 0);
+    }
+    while ((node & 1) != 0) {
+        node >>= 1;
+    }
+    node >>= 1;
+    size_t sample = (node == 0) ? samples : eytzingerRank_[node];
+    if (sample == 0) {
+        return 0;
+    }
+
+    // the bound is after the first item of the block before that sample, count the rest without branches
+    size_t first = (sample - 1) * BLOCK + 1;
+    size_t last = std::min(sample * BLOCK, vec_.size());
+    size_t count = 0;
+    for (size_t i = first; i < last; i++) {
+        count += before(vec_[i], item) ? 1 : 0;
+    }
+    return first + count;
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t SortedVector<TYPE, AllowDuplicate>::CoRank(size_t pos, const std::vector<TYPE>& head,
+    const std::vector<TYPE>& tail)
+{
+    size_t low = (pos > tail.size()) ? (pos - tail.size()) : 0;
+    size_t high = std::min(pos, head.size());
+    while (low < high) {
+        size_t i = low + (high - low) / 2;
+        if (tail[pos - i - 1] < head[i]) {
+            high = i;
+        } else {
+            low = i + 1;
+        }
+    }
+    return low;
+}
+
+template <class TYPE, bool AllowDuplicate>
+size_t SortedVector<TYPE, AllowDuplicate>::ParallelMerge(const SortedVector<TYPE, AllowDuplicate>& sortedVector,
+    size_t threadNum)
+{
+    Flush();
+    const std::vector<TYPE>& tail = sortedVector.vec_;
+    size_t total = vec_.size() + tail.size();
+    if ((threadNum <= 1) || (&sortedVector == this) || (total < threadNum)) {
+        return Merge(sortedVector);
+    }
+
+    // each thread writes its own slice of the output, cut at the same positions in both inputs
+    std::vector<TYPE> merged(total);
+    auto mergePart = [this, &tail, &merged, total, threadNum](size_t part) {
+        size_t begin = total * part / threadNum;
+        size_t end = total * (part + 1) / threadNum;
+        size_t headBegin = CoRank(begin, vec_, tail);
+        size_t headEnd = CoRank(end, vec_, tail);
+        std::merge(vec_.begin() + headBegin, vec_.begin() + headEnd, tail.begin() + (begin - headBegin),
+            tail.begin() + (end - headEnd), merged.begin() + begin);
+    };
+    std::vector<std::thread> threads;
+    for (size_t part = 1; part < threadNum; part++) {
+        threads.emplace_back(mergePart, part);
+    }
+    mergePart(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
     if (!AllowDuplicate) {
-        vec_.clear();
-        std::unique_copy(newVec.begin(), newVec.end(), std::back_inserter(vec_));
-    } else {
-        vec_.swap(newVec);
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
     }
+    vec_.swap(merged);
+    ItemsChanged();
     return vec_.size();
 }
 
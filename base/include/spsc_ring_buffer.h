@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_SPSC_RING_BUFFER_H
+#define UTILS_BASE_SPSC_RING_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace OHOS {
+
+/*
+ * Ring buffer of N slots for exactly one producer thread and one consumer thread. Every operation is wait-free.
+ * Each side works on its own cache lines and only reads the index of the other side when its cached copy says
+ * the buffer is full (producer) or empty (consumer).
+ *
+ * Slots can be used in place: the producer fills the slot returned by Claim() and commits it, the consumer reads
+ * the slot returned by Peek() and releases it. Commits and releases can be published in batches, so the other
+ * side sees one index store per batch instead of one per element.
+ *
+ * With useEventFd, the consumer can sleep until data arrives: it calls PrepareWait() and, if that returns true,
+ * waits for GetEventFd() to be readable, by Wait() or by watching the fd in an EventReactor. Once woken, it calls
+ * ConsumeNotification() and drains the buffer before preparing to wait again.
+ * The producer only writes to the eventfd when the consumer is about to sleep.
+ *
+ * T must be default constructible, N a power of 2.
+ */
+template <typename T, size_t N>
+class SpscRingBuffer {
+    static_assert((N >= 2) && ((N & (N - 1)) == 0), "N must be a power of 2");
+
+public:
+    explicit SpscRingBuffer(bool useEventFd = false)
+        : eventFd_(useEventFd ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1)
+    {
+    }
+
+    ~SpscRingBuffer()
+    {
+        if (eventFd_ >= 0) {
+            close(eventFd_);
+        }
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /* ---- producer thread ---- */
+
+    bool Push(const T& elem)
+    {
+        T* slot = Claim();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = elem;
+        Commit();
+        return true;
+    }
+
+    bool Push(T&& elem)
+    {
+        T* slot = Claim();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = std::move(elem);
+        Commit();
+        return true;
+    }
+
+    // the next free slot, nullptr if full; claiming again before Commit returns the same slot
+    T* Claim()
+    {
+        if (producer_.tail - producer_.cachedHead == N) {
+            producer_.cachedHead = head_.value.load(std::memory_order_acquire);
+            if (producer_.tail - producer_.cachedHead == N) {
+                return nullptr;
+            }
+        }
+        return &slots_[producer_.tail & MASK];
+    }
+
+    // hands the claimed slot to the consumer, which sees it once published
+    void Commit(bool publish = true)
+    {
+        producer_.tail++;
+        if (publish) {
+            Publish();
+        }
+    }
+
+    // makes every commit visible to the consumer
+    void Publish()
+    {
+        if (producer_.tail == producer_.published) {
+            return;
+        }
+        producer_.published = producer_.tail;
+        tail_.value.store(producer_.tail, std::memory_order_release);
+        if (eventFd_ >= 0) {
+            // pairs with the fence in PrepareWait: either the consumer sees the new tail or we see it waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumerWaiting_.load(std::memory_order_relaxed) &&
+                consumerWaiting_.exchange(false, std::memory_order_relaxed)) {
+                uint64_t one = 1;
+                ssize_t ret;
+                do {
+                    ret = write(eventFd_, &one, sizeof(one));
+                } while ((ret < 0) && (errno == EINTR));
+            }
+        }
+    }
+
+    /* ---- consumer thread ---- */
+
+    bool Pop(T& elem)
+    {
+        T* slot = Peek();
+        if (slot == nullptr) {
+            return false;
+        }
+        elem = std::move(*slot);
+        Release();
+        return true;
+    }
+
+    // the oldest published slot, nullptr if empty; it stays valid until released
+    T* Peek()
+    {
+        if (consumer_.head == consumer_.cachedTail) {
+            consumer_.cachedTail = tail_.value.load(std::memory_order_acquire);
+            if (consumer_.head == consumer_.cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots_[consumer_.head & MASK];
+    }
+
+    // gives the peeked slot back to the producer, which can reuse it once published
+    void Release(bool publish = true)
+    {
+        consumer_.head++;
+        if (publish) {
+            PublishReleased();
+        }
+    }
+
+    // makes every release visible to the producer
+    void PublishReleased()
+    {
+        if (consumer_.head != consumer_.published) {
+            consumer_.published = consumer_.head;
+            head_.value.store(consumer_.head, std::memory_order_release);
+        }
+    }
+
+    /*
+     * Returns true if the consumer may now sleep until the eventfd is readable,
+     * false if data arrived meanwhile and the buffer must be drained first.
+     */
+    bool PrepareWait()
+    {
+        if (eventFd_ < 0) {
+            return false;
+        }
+        consumerWaiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (Peek() != nullptr) {
+            consumerWaiting_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // clears the eventfd after it was readable
+    void ConsumeNotification()
+    {
+        uint64_t value = 0;
+        ssize_t ret;
+        do {
+            ret = read(eventFd_, &value, sizeof(value));
+        } while ((ret < 0) && (errno == EINTR));
+    }
+
+    // blocks until data is available or timeoutMs passes(-1: forever), returns whether data is available
+    bool Wait(int timeoutMs)
+    {
+        while (Peek() == nullptr) {
+            if (!PrepareWait()) {
+                if (eventFd_ < 0) {
+                    return false;
+                }
+                continue;
+            }
+            struct pollfd pfd = { eventFd_, POLLIN, 0 };
+            int ret = poll(&pfd, 1, timeoutMs);
+            consumerWaiting_.store(false, std::memory_order_relaxed);
+            if (ret > 0) {
+                ConsumeNotification();
+            } else if ((ret == 0) || (errno != EINTR)) {
+                return Peek() != nullptr;
+            }
+        }
+        return true;
+    }
+
+    int GetEventFd() const { return eventFd_; }
+
+    /* ---- any thread, a tmp status ---- */
+
+    size_t Size() const
+    {
+        size_t head = head_.value.load(std::memory_order_acquire);
+        size_t tail = tail_.value.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    static constexpr size_t Capacity() { return N; }
+
+private:
+    static constexpr size_t MASK = N - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) SharedIndex {
+        std::atomic<size_t> value{0};
+    };
+
+    // only touched by the producer thread
+    struct alignas(CACHE_LINE) ProducerState {
+        size_t tail = 0;  // next slot to fill
+        size_t published = 0;  // last tail stored to tail_
+        size_t cachedHead = 0;  // head_ as last read
+    };
+
+    // only touched by the consumer thread
+    struct alignas(CACHE_LINE) ConsumerState {
+        size_t head = 0;  // next slot to read
+        size_t published = 0;  // last head stored to head_
+        size_t cachedTail = 0;  // tail_ as last read
+    };
+
+    SharedIndex tail_;
+    SharedIndex head_;
+    ProducerState producer_;
+    ConsumerState consumer_;
+    alignas(CACHE_LINE) std::atomic<bool> consumerWaiting_{false};
+    const int eventFd_;
+    alignas(CACHE_LINE) std::array<T, N> slots_ {};
+};
+
+} // namespace OHOS
+#endif
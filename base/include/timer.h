@@ -17,6 +17,9 @@
 #define UTILS_TIMER_H
 
 #include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <cstdint>
 #include <string>
 #include <list>
@@ -30,22 +33,28 @@
 namespace OHOS {
 namespace Utils {
 
+struct TimerStatistics {
+    Log2Histogram lateness;  // ns, from the scheduled deadline to the start of callback
+    Log2Histogram callbackDuration;  // ns
+    Log2Histogram missedExpirations;  // expirations merged into one callback, 0 if none was missed
+};
+
 class Timer {
 public:
     using TimerCallback = std::function<void ()>;
     using TimerCallbackPtr = std::shared_ptr<TimerCallback>;
-    using TimerListCallback = std::function<void (int timerFd)>;
+    using TimerListCallback = std::function<void (int timerFd, uint64_t expirations, uint64_t deadline)>;
 
 public:
     /*
-     * if performance-sensitive, change "timeout" larger before Setup
-     * default-value(1000ms), performance-estimate: occupy fixed-100us in every default-value(1000ms)
-     * timeout: range [-1, INT32MAX], but [-1,0] is not recommended
-     *          -1: wait for ever(until event-trigger);
+     * timeout: range [-1, INT32MAX], -1 is recommended
+     *          -1: wait for ever(until event-trigger or Shutdown), default-value, no periodic wakeup;
      *          0: no wait, occupy too much cpu time;
-     *          others: wait(until event-trigger)
+     *          others: wait(until event-trigger), wake up every timeout ms for nothing
+     * clockId: clock all timers of this instance run on,
+     *          CLOCK_MONOTONIC(default), CLOCK_BOOTTIME(keeps counting in suspend) or CLOCK_REALTIME
      */
-    explicit Timer(const std::string& name, int timeoutMs = 1000);
+    explicit Timer(const std::string& name, int timeoutMs = -1, clockid_t clockId = CLOCK_MONOTONIC);
     virtual ~Timer() {}
 
     virtual uint32_t Setup();
@@ -53,45 +62,115 @@ public:
     /*
      * useJoin true:    use std::thread::join(default)
      *         false:   use std::thread::detach(not recommended)
-     * if timeoutMs = -1 and no valid event-trigger in epoll_wait:
-     *                  use std::thread::detach inside to avoid deadloop
+     * the loop thread is woken up at once, join does not wait for the epoll timeout
      */
     virtual void Shutdown(bool useJoin = true);
 
     uint32_t Register(const TimerCallback& callback, uint32_t interval /* ms */, bool once = false);
+
+    /*
+     * same as above, but the interval is in nanosecond resolution, e.g. std::chrono::microseconds(100)
+     */
+    uint32_t Register(const TimerCallback& callback, std::chrono::nanoseconds interval, bool once = false);
+
+    /*
+     * deadline: absolute time of the first expiration on the timer clock, see Now()
+     * interval: period after the deadline, zero means time out only once
+     * expirations are scheduled as deadline + n * interval, so the timer does not drift
+     */
+    uint32_t RegisterAt(const TimerCallback& callback, std::chrono::nanoseconds deadline,
+        std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero());
+
+    /*
+     * slack: how late the timer is allowed to fire, zero is the same as Register
+     * expirations of slack timers whose windows [deadline, deadline + slack] overlap are
+     * batched into one wakeup, next deadline is always last deadline + interval
+     * use it for low-precision timers to save wakeups and context switches
+     */
+    uint32_t RegisterWithSlack(const TimerCallback& callback, std::chrono::nanoseconds interval,
+        std::chrono::nanoseconds slack, bool once = false);
     void Unregister(uint32_t timerId);
 
+    // wakeups saved by batching expirations of slack timers
+    uint64_t GetSavedWakeups() const { return savedWakeups_; }
+
+    /*
+     * statistics of fire lateness, callback duration and missed expirations, disabled by default
+     * when disabled, no clock is read and nothing is recorded
+     */
+    void EnableStatistics(bool enable) { statisticsEnabled_ = enable; }
+    // aggregate of all timers since statistics were enabled or reset
+    TimerStatistics GetStatistics();
+    // statistics of one timer, false if the timer does not exist or has not fired with statistics enabled
+    bool GetStatistics(uint32_t timerId, TimerStatistics& statistics);
+    void ResetStatistics();
+
+    /*
+     * statistics of the loop thread: wait and dispatch time per iteration, events per wakeup,
+     * duration of each handler and handlers registered, see EventReactor::EnableStatistics
+     * slowHandler: dispatches taking longer are counted and logged, zero means no threshold
+     */
+    void EnableReactorStatistics(bool enable, std::chrono::nanoseconds slowHandler = std::chrono::nanoseconds::zero())
+    {
+        reactor_->EnableStatistics(enable, static_cast<uint64_t>(slowHandler.count()));
+    }
+    ReactorStatistics GetReactorStatistics() { return reactor_->GetStatistics(); }
+    void ResetReactorStatistics() { reactor_->ResetStatistics(); }
+
+    // current time of the timer clock, the reference of RegisterAt's deadline
+    std::chrono::nanoseconds Now() const;
+
 private:
     void MainLoop();
-    void OnTimer(int timerFd);
-    virtual uint32_t DoRegister(const TimerListCallback& callback, uint32_t interval, bool once, int &timerFd);
-    virtual void DoUnregister(uint32_t interval);
-    void DoTimerListCallback(const TimerListCallback& callback, int timerFd);
+    void OnTimer(int timerFd, uint64_t expirations, uint64_t deadline);
+    void OnSlackTimer(int timerFd, uint64_t expirations, uint64_t deadline);
+    uint32_t RearmSlackTimer();
+    uint32_t DoRegisterEntry(const TimerCallback& callback, uint64_t interval /* ns */, uint64_t deadline /* ns */,
+        bool once);
+    virtual uint32_t DoRegister(const TimerListCallback& callback, uint64_t interval, uint64_t deadline, bool once,
+        int &timerFd);
+    virtual void DoUnregister(uint64_t interval);
+    void DoTimerListCallback(const TimerListCallback& callback, int timerFd, uint64_t expirations,
+        uint64_t deadline);
     uint32_t GetValidId(uint32_t timerId) const;
-    int GetTimerFd(uint32_t interval /* ms */);
-    void EraseUnusedTimerId(uint32_t interval, const std::vector<uint32_t>& unusedIds);
+    uint32_t GetNextTimerId();
+    int GetTimerFd(uint64_t interval /* ns */);
+    void EraseUnusedTimerId(uint64_t interval, const std::vector<uint32_t>& unusedIds);
 
 private:
     struct TimerEntry {
         uint32_t       timerId;  // unique id
-        uint32_t       interval;  // million second
+        uint64_t       interval;  // nano second
         TimerCallback  callback;
         bool           once;
+        bool           absolute;  // started at an absolute deadline, owns its timerFd
         int            timerFd;
+        uint64_t       slack;  // nano second, 0 for timers not batched
+        uint64_t       deadline;  // next expiration of slack timer, nano second
+        std::shared_ptr<TimerStatistics> statistics;  // guard by statisticsMutex_, created at the first record
     };
 
     using TimerEntryPtr = std::shared_ptr<TimerEntry>;
+    void DoTimerCallback(const TimerEntryPtr& entry, uint64_t missed, uint64_t deadline);
     using TimerEntryList = std::list<TimerEntryPtr>;
 
-    std::map<uint32_t, TimerEntryList> intervalToTimers_;  // interval to TimerEntryList
+    std::map<uint64_t, TimerEntryList> intervalToTimers_;  // interval to TimerEntryList
     std::map<uint32_t, TimerEntryPtr> timerToEntries_;  // timer_id to TimerEntry
+    std::multimap<uint64_t, TimerEntryPtr> slackTimers_;  // latest expiration(deadline + slack) to slack TimerEntry
+    int slackTimerFd_;  // one timerFd shared by all slack timers
+    uint64_t maxSlack_;
+    std::atomic<uint64_t> savedWakeups_;
 
     std::string name_;
     int timeoutMs_;
+    clockid_t clockId_;
     std::thread thread_;
     std::unique_ptr<EventReactor> reactor_;
-    std::map<uint32_t, uint32_t> timers_;  // timer_fd to interval
+    std::map<uint32_t, uint64_t> timers_;  // timer_fd to interval
     std::mutex mutex_;
+    std::atomic<bool> statisticsEnabled_;
+    std::mutex statisticsMutex_;
+    TimerStatistics statistics_;  // guard by statisticsMutex_
 };
 
 } // namespace Utils
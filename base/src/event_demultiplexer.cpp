@@ -16,14 +16,18 @@
 #include "event_demultiplexer.h"
 #include "event_reactor.h"
 #include "event_handler.h"
+#include "io_uring_demultiplexer.h"
 #include "common_timer_errors.h"
 #include "utils_log.h"
 
+#include <algorithm>
 #include <vector>
 #include <cstdio>
+#include <ctime>
 #include <strings.h>
 #include <unistd.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 namespace OHOS {
 namespace Utils {
@@ -32,8 +36,26 @@ static const int EPOLL_MAX_EVENS_INIT = 8;
 static const int HALF_OF_MAX_EVENT = 2;
 static const int EPOLL_INVALID_FD = -1;
 
-EventDemultiplexer::EventDemultiplexer()
-    : epollFd_(epoll_create1(EPOLL_CLOEXEC)), maxEvents_(EPOLL_MAX_EVENS_INIT), mutex_(), eventHandlers_()
+std::unique_ptr<EventDemultiplexer> EventDemultiplexer::Create(DemultiplexerBackend backend)
+{
+    if (backend == DemultiplexerBackend::IO_URING) {
+        std::unique_ptr<IoUringDemultiplexer> demultiplexer(new IoUringDemultiplexer());
+        if (demultiplexer->IsValid()) {
+            return demultiplexer;
+        }
+        UTILS_LOGI("io_uring is not available, fall back to epoll.");
+    }
+    return std::unique_ptr<EventDemultiplexer>(new EventDemultiplexer());
+}
+
+EventDemultiplexer::EventDemultiplexer() : EventDemultiplexer(true)
+{
+}
+
+EventDemultiplexer::EventDemultiplexer(bool useEpoll)
+    : mutex_(), epollFd_(useEpoll ? epoll_create1(EPOLL_CLOEXEC) : EPOLL_INVALID_FD), wakeupFd_(EPOLL_INVALID_FD),
+      maxEvents_(EPOLL_MAX_EVENS_INIT), epollEvents_(EPOLL_MAX_EVENS_INIT), eventHandlers_(), handlerCount_(0),
+      wakeupHandler_()
 {
 }
 
@@ -42,7 +64,12 @@ EventDemultiplexer::~EventDemultiplexer()
     CleanUp();
 }
 
-uint32_t EventDemultiplexer::StartUp()
+DemultiplexerBackend EventDemultiplexer::GetBackend() const
+{
+    return DemultiplexerBackend::EPOLL;
+}
+
+uint32_t EventDemultiplexer::StartBackend()
 {
     if (epollFd_ < 0) {
         epollFd_ = epoll_create1(EPOLL_CLOEXEC);
@@ -54,7 +81,7 @@ uint32_t EventDemultiplexer::StartUp()
     return TIMER_ERR_OK;
 }
 
-void EventDemultiplexer::CleanUp()
+void EventDemultiplexer::CleanBackend()
 {
     if (epollFd_ != EPOLL_INVALID_FD) {
         close(epollFd_);
@@ -62,6 +89,60 @@ void EventDemultiplexer::CleanUp()
     }
 }
 
+uint32_t EventDemultiplexer::StartUp()
+{
+    uint32_t ret = StartBackend();
+    if (ret != TIMER_ERR_OK) {
+        return ret;
+    }
+
+    if (wakeupFd_ < 0) {
+        wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeupFd_ < 0) {
+            UTILS_LOGE("eventfd failed.");
+            return TIMER_ERR_BADF;
+        }
+        // no reactor behind the wakeup handler, it is registered here directly
+        wakeupHandler_.reset(new EventHandler(wakeupFd_, nullptr));
+        wakeupHandler_->SetReadCallback(std::bind(&EventDemultiplexer::DrainWakeup, this));
+        wakeupHandler_->EnableRead();
+        ret = UpdateEventHandler(wakeupHandler_.get());
+        if (ret != TIMER_ERR_OK) {
+            UTILS_LOGE("register wakeup handler failed.");
+            return ret;
+        }
+    }
+    return TIMER_ERR_OK;
+}
+
+void EventDemultiplexer::CleanUp()
+{
+    CleanBackend();
+    if (wakeupFd_ != EPOLL_INVALID_FD) {
+        close(wakeupFd_);
+        wakeupFd_ = EPOLL_INVALID_FD;
+    }
+}
+
+void EventDemultiplexer::Wakeup()
+{
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeupFd_, &one, sizeof(one));
+    if (n != sizeof(one)) {
+        // EAGAIN means the counter is saturated, the loop is going to wake up anyway
+        UTILS_LOGD("wakeup writes %{public}d bytes instead of 8.", static_cast<int>(n));
+    }
+}
+
+void EventDemultiplexer::DrainWakeup()
+{
+    uint64_t count = 0;
+    ssize_t n = ::read(wakeupFd_, &count, sizeof(count));
+    if (n != sizeof(count)) {
+        UTILS_LOGD("wakeup reads %{public}d bytes instead of 8.", static_cast<int>(n));
+    }
+}
+
 uint32_t EventDemultiplexer::UpdateEventHandler(EventHandler* handler)
 {
     if (handler == nullptr) {
@@ -69,19 +150,33 @@ uint32_t EventDemultiplexer::UpdateEventHandler(EventHandler* handler)
         return TIMER_ERR_INVALID_VALUE;
     }
 
+    int fd = handler->GetHandle();
+    if (fd < 0) {
+        UTILS_LOGE("invalid handle %{public}d.", fd);
+        return TIMER_ERR_BADF;
+    }
+
     std::lock_guard<std::recursive_mutex> lock(mutex_);
-    auto itor = eventHandlers_.find(handler->GetHandle());
-    if (itor == eventHandlers_.end()) {
-        eventHandlers_.insert(std::make_pair(handler->GetHandle(), handler));
-        return Update(EPOLL_CTL_ADD, handler);
+    EventHandler* current = FindEventHandler(fd);
+    if (current == nullptr) {
+        uint32_t ret = Update(EPOLL_CTL_ADD, handler);
+        if (ret == TIMER_ERR_OK) {
+            if (fd >= static_cast<int>(eventHandlers_.size())) {
+                eventHandlers_.resize(fd + 1, nullptr);
+            }
+            eventHandlers_[fd] = handler;
+            handlerCount_++;
+        }
+        return ret;
     }
 
     if (handler->Events() == EventReactor::NONE_EVENT) {
-        eventHandlers_.erase(itor);
+        eventHandlers_[fd] = nullptr;
+        handlerCount_--;
         return Update(EPOLL_CTL_DEL, handler);
     }
 
-    if (handler != itor->second) {
+    if (handler != current) {
         UTILS_LOGE("invalid event handler!");
         return TIMER_ERR_DEAL_FAILED;
     }
@@ -96,24 +191,34 @@ uint32_t EventDemultiplexer::RemoveEventHandler(EventHandler* handler)
     }
 
     std::lock_guard<std::recursive_mutex> lock(mutex_);
-    auto itor = eventHandlers_.find(handler->GetHandle());
-    if (itor == eventHandlers_.end()) {
+    int fd = handler->GetHandle();
+    if (FindEventHandler(fd) == nullptr) {
         return TIMER_ERR_OK;
     }
 
-    eventHandlers_.erase(itor);
-    if (static_cast<int>(eventHandlers_.size()) < maxEvents_) {
-        maxEvents_ = eventHandlers_.size() / HALF_OF_MAX_EVENT;
+    eventHandlers_[fd] = nullptr;
+    handlerCount_--;
+    if (handlerCount_ < maxEvents_) {
+        // never shrink to 0, epoll_wait fails at once with maxevents 0 and the loop spins
+        maxEvents_ = std::max(handlerCount_ / HALF_OF_MAX_EVENT, EPOLL_MAX_EVENS_INIT);
     }
 
     return Update(EPOLL_CTL_DEL, handler);
 }
 
+EventHandler* EventDemultiplexer::FindEventHandler(int fd) const
+{
+    if ((fd < 0) || (fd >= static_cast<int>(eventHandlers_.size()))) {
+        return nullptr;
+    }
+    return eventHandlers_[fd];
+}
+
 uint32_t EventDemultiplexer::Update(int operation, EventHandler* handler)
 {
     struct epoll_event event;
     bzero(&event, sizeof(event));
-    event.events   = Reactor2Epoll(handler->Events());
+    event.events   = Reactor2Epoll(handler->Events()) | TriggerFlags2Epoll(handler->TriggerFlags());
     event.data.ptr = reinterpret_cast<void*>(handler);
 
     if (epoll_ctl(epollFd_, operation, handler->GetHandle(), &event) != 0) {
@@ -124,10 +229,47 @@ uint32_t EventDemultiplexer::Update(int operation, EventHandler* handler)
     return TIMER_ERR_OK;
 }
 
-void EventDemultiplexer::Polling(int timeout /* ms */)
+uint32_t EventDemultiplexer::GetHandlerCount()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return static_cast<uint32_t>(handlerCount_);
+}
+
+uint64_t EventDemultiplexer::MonotonicNow()
 {
-    std::vector<struct epoll_event> epollEvents(maxEvents_);
-    int nfds = epoll_wait(epollFd_, &epollEvents[0], static_cast<int>(epollEvents.size()), timeout);
+    static const uint64_t nanoToBase = 1000000000;
+    struct timespec now = {0, 0};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * nanoToBase + static_cast<uint64_t>(now.tv_nsec);
+}
+
+void EventDemultiplexer::Dispatch(EventHandler* handler, uint32_t events, PollingRecord* record)
+{
+    if (record == nullptr) {
+        handler->HandleEvents(events);
+        return;
+    }
+    // the handler may be gone when HandleEvents returns, e.g. a once timer
+    int fd = handler->GetHandle();
+    uint64_t begin = MonotonicNow();
+    handler->HandleEvents(events);
+    record->handlerDurations.emplace_back(fd, MonotonicNow() - begin);
+}
+
+void EventDemultiplexer::Polling(int timeout /* ms */, PollingRecord* record)
+{
+    int maxEvents = maxEvents_;
+    if (static_cast<int>(epollEvents_.size()) != maxEvents) {
+        // shrinking keeps the capacity, only growing beyond it allocates
+        epollEvents_.resize(maxEvents);
+    }
+    uint64_t begin = (record != nullptr) ? MonotonicNow() : 0;
+    int nfds = epoll_wait(epollFd_, epollEvents_.data(), maxEvents, timeout);
+    if (record != nullptr) {
+        record->waitTime = MonotonicNow() - begin;
+        record->events = (nfds > 0) ? static_cast<uint32_t>(nfds) : 0;
+        record->handlerDurations.clear();
+    }
     if (nfds == 0) {
         return;
     }
@@ -137,38 +279,54 @@ void EventDemultiplexer::Polling(int timeout /* ms */)
     }
 
     for (int idx = 0; idx < nfds; ++idx) {
-        int events = epollEvents[idx].events;
-        void* ptr = epollEvents[idx].data.ptr;
+        int events = epollEvents_[idx].events;
+        void* ptr = epollEvents_[idx].data.ptr;
         auto handler = reinterpret_cast<EventHandler*>(ptr);
         if (handler != nullptr) {
-            handler->HandleEvents(Epoll2Reactor(events));
+            Dispatch(handler, Epoll2Reactor(events), record);
         }
     }
 
-    if (nfds == maxEvents_) {
-        maxEvents_ *= HALF_OF_MAX_EVENT;
+    if (nfds == maxEvents) {
+        // more events may be pending, fetch them in fewer wakeups next time, but no more than the handlers
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        maxEvents_ = std::max(std::min(maxEvents * HALF_OF_MAX_EVENT, handlerCount_), maxEvents);
     }
 }
 
+// every event reported together is dispatched together, edge triggered and one shot fds do not report them again
 uint32_t EventDemultiplexer::Epoll2Reactor(uint32_t epollEvents)
 {
+    uint32_t events = EventReactor::NONE_EVENT;
     if ((epollEvents & EPOLLHUP) && !(epollEvents & EPOLLIN)) {
-        return EventReactor::CLOSE_EVENT;
+        events |= EventReactor::CLOSE_EVENT;
     }
 
     if (epollEvents & EPOLLERR) {
-        return EventReactor::ERROR_EVENT;
+        events |= EventReactor::ERROR_EVENT;
     }
 
     if (epollEvents & (EPOLLIN | EPOLLPRI | EPOLLRDHUP)) {
-        return EventReactor::READ_EVENT;
+        events |= EventReactor::READ_EVENT;
     }
 
     if (epollEvents & EPOLLOUT) {
-        return EventReactor::WRITE_EVENT;
+        events |= EventReactor::WRITE_EVENT;
     }
 
-    return EventReactor::NONE_EVENT;
+    return events;
+}
+
+uint32_t EventDemultiplexer::TriggerFlags2Epoll(uint32_t flags)
+{
+    uint32_t epollFlags = 0;
+    if (flags & EventHandler::EDGE_TRIGGERED) {
+        epollFlags |= EPOLLET;
+    }
+    if (flags & EventHandler::ONE_SHOT) {
+        epollFlags |= EPOLLONESHOT;
+    }
+    return epollFlags;
 }
 
 uint32_t EventDemultiplexer::Reactor2Epoll(uint32_t reactorEvent)
@@ -16,39 +16,86 @@
 #ifndef UTILS_EVENT_DEMULTIPLEXER_H
 #define UTILS_EVENT_DEMULTIPLEXER_H
 
+#include <sys/epoll.h>
+#include <atomic>
 #include <mutex>
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace OHOS {
 namespace Utils {
 
 class EventHandler;
+enum class DemultiplexerBackend;
+
+// what one Polling did, filled only when asked for
+struct PollingRecord {
+    uint64_t waitTime = 0;  // ns
+    uint32_t events = 0;
+    std::vector<std::pair<int, uint64_t>> handlerDurations;  // fd and ns of each dispatch
+};
 
 class EventDemultiplexer {
 public:
+    // the epoll demultiplexer if backend is not supported by the kernel or the build
+    static std::unique_ptr<EventDemultiplexer> Create(DemultiplexerBackend backend);
+
     EventDemultiplexer();
     EventDemultiplexer(const EventDemultiplexer&) = delete;
     EventDemultiplexer& operator=(const EventDemultiplexer&) = delete;
     virtual ~EventDemultiplexer();
 
+    virtual DemultiplexerBackend GetBackend() const;
+
     uint32_t StartUp();
     void CleanUp();
 
-    void Polling(int timeout);
+    /*
+     * events are dispatched from an array kept across calls, it grows when full and never allocates otherwise
+     * record: nullptr, or filled with the wait time, events and dispatch durations of this call
+     */
+    virtual void Polling(int timeout, PollingRecord* record = nullptr);
+
+    // interrupt a blocking Polling from any thread
+    void Wakeup();
 
     uint32_t UpdateEventHandler(EventHandler* handler);
     uint32_t RemoveEventHandler(EventHandler* handler);
+    uint32_t GetHandlerCount();
+
+    // ns of CLOCK_MONOTONIC
+    static uint64_t MonotonicNow();
+
+protected:
+    // backends other than epoll do not create the epoll instance
+    explicit EventDemultiplexer(bool useEpoll);
+
+    // kernel side of the backend, called with mutex_ held for Update
+    virtual uint32_t StartBackend();
+    virtual void CleanBackend();
+    // operation: EPOLL_CTL_ADD, EPOLL_CTL_MOD or EPOLL_CTL_DEL
+    virtual uint32_t Update(int operation, EventHandler* handler);
 
-private:
-    uint32_t Update(int operation, EventHandler* handler);
     static uint32_t Reactor2Epoll(uint32_t reactorEvent);
     static uint32_t Epoll2Reactor(uint32_t epollEvents);
+    static void Dispatch(EventHandler* handler, uint32_t events, PollingRecord* record);
 
-    int epollFd_;
-    int maxEvents_;
     std::recursive_mutex mutex_;
-    std::map<int, EventHandler*> eventHandlers_; // guard by mutex_
+
+private:
+    EventHandler* FindEventHandler(int fd) const;
+    static uint32_t TriggerFlags2Epoll(uint32_t flags);
+    void DrainWakeup();
+
+    int epollFd_;
+    int wakeupFd_;  // eventfd, written by Wakeup
+    std::atomic<int> maxEvents_;  // events fetched per epoll_wait, follows the number of handlers
+    std::vector<struct epoll_event> epollEvents_;  // only touched by the polling thread
+    std::vector<EventHandler*> eventHandlers_; // guard by mutex_, indexed by fd
+    int handlerCount_; // guard by mutex_
+    std::unique_ptr<EventHandler> wakeupHandler_;
 };
 
 }
@@ -15,13 +15,14 @@
 
 #include "event_handler.h"
 #include "event_reactor.h"
+#include "common_timer_errors.h"
 #include <sys/epoll.h>
 
 namespace OHOS {
 namespace Utils {
 
 EventHandler::EventHandler(int fd, EventReactor* r)
-    :fd_(fd), events_(EventReactor::NONE_EVENT), reactor_(r)
+    :fd_(fd), events_(EventReactor::NONE_EVENT), triggerFlags_(0), reactor_(r)
 {
 }
 
@@ -48,6 +49,15 @@ void EventHandler::DisableAll()
     Update();
 }
 
+uint32_t EventHandler::SetEvents(uint32_t events)
+{
+    events_ = events;
+    if (reactor_ == nullptr) {
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    return reactor_->UpdateEventHandler(this);
+}
+
 void EventHandler::HandleEvents(uint32_t events)
 {
     if (events & (EventReactor::CLOSE_EVENT)) {
@@ -29,6 +29,14 @@ class EventHandler {
 public:
     using Callback = std::function<void()>;
 
+    /*
+     * trigger flags, level triggered if none is set
+     * EDGE_TRIGGERED: report an event only when the state changes, drain the fd until EAGAIN
+     * ONE_SHOT:       report one event then disable the fd, re-arm it by updating the events
+     */
+    static const uint32_t EDGE_TRIGGERED = 0x0001;
+    static const uint32_t ONE_SHOT       = 0x0002;
+
     EventHandler(int fd, EventReactor* r);
     EventHandler& operator=(const EventHandler&) = delete;
     EventHandler(const EventHandler&) = delete;
@@ -38,11 +46,17 @@ public:
 
     int GetHandle() const { return (fd_); }
     uint32_t Events() const { return (events_); }
+    uint32_t TriggerFlags() const { return (triggerFlags_); }
+
+    // takes effect at the next update of the events
+    void SetTriggerFlags(uint32_t flags) { triggerFlags_ = flags; }
 
     void EnableRead();
     void EnableWrite();
     void DisableWrite();
     void DisableAll();
+    // replace the events watched at once, NONE_EVENT removes the handler from the reactor
+    uint32_t SetEvents(uint32_t events);
 
     const EventReactor* GetEventReactor() const { return reactor_; }
 
@@ -59,6 +73,7 @@ private:
 private:
     int             fd_;
     uint32_t        events_;
+    uint32_t        triggerFlags_;
     EventReactor*   reactor_;
 
     Callback  readCallback_;
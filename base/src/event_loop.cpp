@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event_loop.h"
+
+#include <sys/inotify.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include "common_timer_errors.h"
+#include "event_handler.h"
+#include "inotify_event_handler.h"
+#include "signal_event_handler.h"
+#include "utils_log.h"
+
+namespace OHOS {
+namespace Utils {
+
+static const uint32_t VALID_EVENTS = EventLoop::READ | EventLoop::WRITE | EventLoop::EDGE_TRIGGERED |
+    EventLoop::ONE_SHOT;
+
+struct EventLoop::FdEntry {
+    explicit FdEntry(int fd, EventReactor* reactor) : handler(fd, reactor), callbacks(), removed(false) {}
+
+    EventHandler handler;
+    FdCallbacks callbacks;
+    std::atomic<bool> removed;  // events already polled are dropped once it is set
+};
+
+EventLoop::EventLoop(const std::string& name, int timeoutMs, clockid_t clockId, DemultiplexerBackend backend)
+    : name_(name), timeoutMs_(timeoutMs), clockId_(clockId), reactor_(new EventReactor(backend)), nextTimerId_(0)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    Shutdown();
+}
+
+uint32_t EventLoop::Setup()
+{
+    if (!reactor_->IsStopped()) {
+        UTILS_LOGD("event loop %{public}s is running already", name_.c_str());
+        return TIMER_ERR_OK;
+    }
+
+    uint32_t ret = reactor_->StartUp();
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("reactor start up failed, return %{public}u", ret);
+        reactor_->CleanUp();
+        return ret;
+    }
+
+    std::thread loopThread(std::bind(&EventLoop::MainLoop, this));
+    thread_.swap(loopThread);
+    return TIMER_ERR_OK;
+}
+
+void EventLoop::Shutdown(bool useJoin)
+{
+    if (reactor_->IsStopped()) {
+        UTILS_LOGD("event loop has been stopped already");
+        return;
+    }
+
+    reactor_->StopLoop();
+    if (!useJoin) {
+        thread_.detach();
+        return;
+    }
+    thread_.join();
+}
+
+void EventLoop::MainLoop()
+{
+    prctl(PR_SET_NAME, name_.c_str(), 0, 0, 0);
+    reactor_->RunLoop(timeoutMs_);
+    RemoveAll();
+    ReleaseRemoved();
+    reactor_->CleanUp();
+}
+
+uint32_t EventLoop::AddFd(int fd, uint32_t events, const FdCallbacks& callbacks)
+{
+    if ((fd < 0) || ((events & ~VALID_EVENTS) != 0)) {
+        UTILS_LOGE("invalid fd %{public}d or events %{public}u", fd, events);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fdEntries_.find(fd) != fdEntries_.end()) {
+        UTILS_LOGE("fd %{public}d has been added already", fd);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+
+    FdEntryPtr entry = std::make_shared<FdEntry>(fd, reactor_.get());
+    entry->callbacks = callbacks;
+    // the entry outlives the dispatch of events polled before its removal, see ReleaseRemoved
+    FdEntry* ptr = entry.get();
+    auto dispatch = [ptr](Callback FdCallbacks::* callback) {
+        if (!ptr->removed && (ptr->callbacks.*callback)) {
+            (ptr->callbacks.*callback)();
+        }
+    };
+    entry->handler.SetReadCallback(std::bind(dispatch, &FdCallbacks::onRead));
+    entry->handler.SetWriteCallback(std::bind(dispatch, &FdCallbacks::onWrite));
+    entry->handler.SetCloseCallback(std::bind(dispatch, &FdCallbacks::onClose));
+    entry->handler.SetErrorCallback(std::bind(dispatch, &FdCallbacks::onError));
+    uint32_t ret = SetHandlerEvents(entry->handler, events);
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("add fd %{public}d failed, return %{public}u", fd, ret);
+        return ret;
+    }
+    fdEntries_[fd] = entry;
+    return TIMER_ERR_OK;
+}
+
+uint32_t EventLoop::SetHandlerEvents(EventHandler& handler, uint32_t events)
+{
+    uint32_t flags = 0;
+    if (events & EDGE_TRIGGERED) {
+        flags |= EventHandler::EDGE_TRIGGERED;
+    }
+    if (events & ONE_SHOT) {
+        flags |= EventHandler::ONE_SHOT;
+    }
+    handler.SetTriggerFlags(flags);
+    return handler.SetEvents(events & (READ | WRITE));
+}
+
+uint32_t EventLoop::ModifyFd(int fd, uint32_t events)
+{
+    if ((events & ~VALID_EVENTS) != 0) {
+        UTILS_LOGE("invalid events %{public}u", events);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = fdEntries_.find(fd);
+    if (itor == fdEntries_.end()) {
+        UTILS_LOGE("fd %{public}d not found", fd);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    return SetHandlerEvents(itor->second->handler, events);
+}
+
+void EventLoop::RemoveFd(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = fdEntries_.find(fd);
+        if (itor == fdEntries_.end()) {
+            UTILS_LOGD("fd %{public}d not found", fd);
+            return;
+        }
+        itor->second->removed = true;
+        reactor_->RemoveEventHandler(&itor->second->handler);
+        removedEntries_.push_back(itor->second);
+        fdEntries_.erase(itor);
+    }
+    reactor_->PostTask(std::bind(&EventLoop::ReleaseRemoved, this));
+}
+
+uint32_t EventLoop::AddTimer(const Callback& callback, std::chrono::nanoseconds interval, bool once)
+{
+    if ((interval.count() <= 0) || !callback) {
+        UTILS_LOGE("invalid interval %{public}lld ns or callback", static_cast<long long>(interval.count()));
+        return TIMER_ERR_DEAL_FAILED;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t timerId = GetNextTimerId();
+    int timerFd = -1;
+    uint32_t ret = reactor_->ScheduleTimer(std::bind(&EventLoop::OnTimer, this, timerId, once),
+        static_cast<uint64_t>(interval.count()), 0, clockId_, timerFd, once);
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("ScheduleTimer failed, return %{public}u", ret);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    timers_[timerId] = std::make_pair(timerFd, callback);
+    return timerId;
+}
+
+void EventLoop::RemoveTimer(uint32_t timerId)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = timers_.find(timerId);
+        if (itor == timers_.end()) {
+            UTILS_LOGD("timer %{public}u not found", timerId);
+            return;
+        }
+        // the timer handler may be running its callback, cancel it after dispatch
+        removedTimerFds_.push_back(itor->second.first);
+        timers_.erase(itor);
+    }
+    reactor_->PostTask(std::bind(&EventLoop::ReleaseRemoved, this));
+}
+
+uint32_t EventLoop::AddSignal(int signo, const SignalCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (signalHandler_ == nullptr) {
+        signalHandler_.reset(new SignalEventHandler(reactor_.get()));
+        signalHandler_->SetSignalCallback(std::bind(&EventLoop::OnSignal, this, std::placeholders::_1));
+    }
+    uint32_t ret = signalHandler_->AddSignal(signo);
+    if (ret != TIMER_ERR_OK) {
+        return ret;
+    }
+    ret = signalHandler_->Initialize();
+    if (ret != TIMER_ERR_OK) {
+        signalHandler_->RemoveSignal(signo);
+        return ret;
+    }
+    signalCallbacks_[signo] = callback;
+    return TIMER_ERR_OK;
+}
+
+void EventLoop::RemoveSignal(int signo)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((signalHandler_ == nullptr) || (signalCallbacks_.erase(signo) == 0)) {
+        UTILS_LOGD("signal %{public}d not found", signo);
+        return;
+    }
+    signalHandler_->RemoveSignal(signo);
+}
+
+int EventLoop::WatchPath(const std::string& path, uint32_t mask, const FileCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inotifyHandler_ == nullptr) {
+        inotifyHandler_.reset(new InotifyEventHandler(reactor_.get()));
+        using namespace std::placeholders;
+        inotifyHandler_->SetInotifyCallback(std::bind(&EventLoop::OnFileEvent, this, _1, _2, _3, _4));
+    }
+    if (inotifyHandler_->Initialize() != TIMER_ERR_OK) {
+        return -1;
+    }
+    int wd = inotifyHandler_->AddWatch(path, mask);
+    if (wd >= 0) {
+        fileCallbacks_[wd] = callback;
+    }
+    return wd;
+}
+
+void EventLoop::UnwatchPath(int wd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((inotifyHandler_ == nullptr) || (fileCallbacks_.erase(wd) == 0)) {
+        UTILS_LOGD("watch %{public}d not found", wd);
+        return;
+    }
+    inotifyHandler_->RemoveWatch(wd);
+}
+
+void EventLoop::PostTask(const Task& task)
+{
+    reactor_->PostTask(task);
+}
+
+void EventLoop::OnTimer(uint32_t timerId, bool once)
+{
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = timers_.find(timerId);
+        if (itor == timers_.end()) {
+            return;
+        }
+        callback = itor->second.second;
+    }
+    if (once) {
+        RemoveTimer(timerId);
+    }
+    callback();
+}
+
+void EventLoop::OnSignal(const struct signalfd_siginfo& info)
+{
+    SignalCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = signalCallbacks_.find(static_cast<int>(info.ssi_signo));
+        if (itor == signalCallbacks_.end()) {
+            return;
+        }
+        callback = itor->second;
+    }
+    callback(info);
+}
+
+void EventLoop::OnFileEvent(int wd, uint32_t mask, uint32_t cookie, const std::string& name)
+{
+    FileCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = fileCallbacks_.find(wd);
+        if (itor == fileCallbacks_.end()) {
+            return;
+        }
+        callback = itor->second;
+        if (mask & IN_IGNORED) {
+            // the watch is gone with the path, this is its last event
+            fileCallbacks_.erase(itor);
+        }
+    }
+    callback(wd, mask, cookie, name);
+}
+
+void EventLoop::RemoveAll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (signalHandler_ != nullptr) {
+        for (auto& itor : signalCallbacks_) {
+            signalHandler_->RemoveSignal(itor.first);
+        }
+        signalHandler_->Uninitialize();
+    }
+    signalCallbacks_.clear();
+    if (inotifyHandler_ != nullptr) {
+        for (auto& itor : fileCallbacks_) {
+            inotifyHandler_->RemoveWatch(itor.first);
+        }
+        inotifyHandler_->Uninitialize();
+    }
+    fileCallbacks_.clear();
+    for (auto& itor : fdEntries_) {
+        itor.second->removed = true;
+        reactor_->RemoveEventHandler(&itor.second->handler);
+        removedEntries_.push_back(itor.second);
+    }
+    fdEntries_.clear();
+    for (auto& itor : timers_) {
+        removedTimerFds_.push_back(itor.second.first);
+    }
+    timers_.clear();
+}
+
+void EventLoop::ReleaseRemoved()
+{
+    std::vector<FdEntryPtr> entries;
+    std::vector<int> timerFds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries.swap(removedEntries_);
+        timerFds.swap(removedTimerFds_);
+    }
+    for (int timerFd : timerFds) {
+        reactor_->CancelTimer(timerFd);
+    }
+}
+
+/* valid range: [1, UINT32_MAX], but not TIMER_ERR_DEAL_FAILED, same as Timer */
+uint32_t EventLoop::GetNextTimerId()
+{
+    do {
+        nextTimerId_++;
+    } while ((nextTimerId_ == 0) || (nextTimerId_ == TIMER_ERR_DEAL_FAILED) ||
+        (timers_.find(nextTimerId_) != timers_.end()));
+    return nextTimerId_;
+}
+
+} // namespace Utils
+} // namespace OHOS
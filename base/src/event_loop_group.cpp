@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event_loop_group.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+#include <sched.h>
+#include "common_timer_errors.h"
+#include "utils_log.h"
+
+namespace OHOS {
+namespace Utils {
+
+static const uint32_t FD_HASH_MULTIPLIER = 2654435761u;  // Knuth's multiplicative hash
+
+EventLoopGroup::EventLoopGroup(const std::string& name, uint32_t loops, AssignPolicy policy, bool pinToCore,
+    int timeoutMs, clockid_t clockId, DemultiplexerBackend backend)
+    : name_(name), policy_(policy), pinToCore_(pinToCore), loops_(), nextLoop_(0), records_(), migrations_(0)
+{
+    if (loops == 0) {
+        loops = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (uint32_t i = 0; i < loops; i++) {
+        loops_.emplace_back(new EventLoop(name + "_" + std::to_string(i), timeoutMs, clockId, backend));
+    }
+}
+
+EventLoopGroup::~EventLoopGroup()
+{
+    Shutdown();
+}
+
+uint32_t EventLoopGroup::Setup()
+{
+    for (uint32_t i = 0; i < loops_.size(); i++) {
+        uint32_t ret = loops_[i]->Setup();
+        if (ret != TIMER_ERR_OK) {
+            UTILS_LOGE("setup loop %{public}u of %{public}s failed, return %{public}u", i, name_.c_str(), ret);
+            for (uint32_t j = 0; j < i; j++) {
+                loops_[j]->Shutdown();
+            }
+            return ret;
+        }
+        if (pinToCore_) {
+            loops_[i]->PostTask(std::bind(&EventLoopGroup::PinToCore, this, i));
+        }
+    }
+    return TIMER_ERR_OK;
+}
+
+void EventLoopGroup::Shutdown(bool useJoin)
+{
+    for (auto& loop : loops_) {
+        loop->Shutdown(useJoin);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+}
+
+EventLoop* EventLoopGroup::GetLoop(uint32_t index)
+{
+    return (index < loops_.size()) ? loops_[index].get() : nullptr;
+}
+
+void EventLoopGroup::PinToCore(uint32_t index)
+{
+    uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(index % cores, &cpuSet);
+    // pid 0 is the calling thread, this runs in the loop thread
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+        UTILS_LOGE("pin loop %{public}u to core %{public}u failed, errno %{public}d", index, index % cores, errno);
+    }
+}
+
+uint32_t EventLoopGroup::PickLoop(int fd)
+{
+    uint32_t loops = static_cast<uint32_t>(loops_.size());
+    if (policy_ == AssignPolicy::HASH_FD) {
+        return (static_cast<uint32_t>(fd) * FD_HASH_MULTIPLIER) % loops;
+    }
+    return nextLoop_.fetch_add(1, std::memory_order_relaxed) % loops;
+}
+
+uint32_t EventLoopGroup::AddFd(int fd, uint32_t events, const EventLoop::FdCallbacks& callbacks)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (records_.find(fd) != records_.end()) {
+        UTILS_LOGE("fd %{public}d has been added already", fd);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    uint32_t index = PickLoop(fd);
+    uint32_t ret = loops_[index]->AddFd(fd, events, callbacks);
+    if (ret != TIMER_ERR_OK) {
+        return ret;
+    }
+    records_[fd] = FdRecord{index, events, callbacks, false, index, 0};
+    return TIMER_ERR_OK;
+}
+
+uint32_t EventLoopGroup::ModifyFd(int fd, uint32_t events)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = records_.find(fd);
+    if (itor == records_.end()) {
+        UTILS_LOGE("fd %{public}d not found", fd);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    itor->second.events = events;
+    if (itor->second.migrating) {
+        // applied when it is added to the new loop
+        return TIMER_ERR_OK;
+    }
+    return loops_[itor->second.loop]->ModifyFd(fd, events);
+}
+
+void EventLoopGroup::RemoveFd(int fd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = records_.find(fd);
+    if (itor == records_.end()) {
+        UTILS_LOGD("fd %{public}d not found", fd);
+        return;
+    }
+    // a migrating fd is still in its old loop, removed from there at once so no callback runs after this returns;
+    // the pending DoMigrate finds no record, or a record of the fd number added again, and leaves it alone
+    loops_[itor->second.migrating ? itor->second.fromLoop : itor->second.loop]->RemoveFd(fd);
+    records_.erase(itor);
+}
+
+int EventLoopGroup::GetLoopIndex(int fd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = records_.find(fd);
+    return (itor == records_.end()) ? -1 : static_cast<int>(itor->second.loop);
+}
+
+uint32_t EventLoopGroup::MigrateFd(int fd, uint32_t toLoop)
+{
+    if (toLoop >= loops_.size()) {
+        UTILS_LOGE("invalid loop %{public}u", toLoop);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+
+    uint32_t fromLoop = 0;
+    uint64_t migration = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itor = records_.find(fd);
+        if (itor == records_.end()) {
+            UTILS_LOGE("fd %{public}d not found", fd);
+            return TIMER_ERR_INVALID_VALUE;
+        }
+        if (itor->second.migrating) {
+            return TIMER_ERR_DEAL_FAILED;
+        }
+        if (itor->second.loop == toLoop) {
+            return TIMER_ERR_OK;
+        }
+        fromLoop = itor->second.loop;
+        migration = ++migrations_;
+        itor->second.loop = toLoop;
+        itor->second.migrating = true;
+        itor->second.fromLoop = fromLoop;
+        itor->second.migration = migration;
+    }
+
+    if (loops_[fromLoop]->IsInLoopThread()) {
+        DoMigrate(fd, fromLoop, toLoop, migration);
+    } else {
+        loops_[fromLoop]->PostTask(std::bind(&EventLoopGroup::DoMigrate, this, fd, fromLoop, toLoop, migration));
+    }
+    return TIMER_ERR_OK;
+}
+
+void EventLoopGroup::DoMigrate(int fd, uint32_t fromLoop, uint32_t toLoop, uint64_t migration)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = records_.find(fd);
+    if ((itor == records_.end()) || !itor->second.migrating || (itor->second.migration != migration)) {
+        // removed from the group meanwhile, RemoveFd took it out of fromLoop; the fd number may be in use again
+        return;
+    }
+    loops_[fromLoop]->RemoveFd(fd);
+    itor->second.migrating = false;
+    uint32_t ret = loops_[toLoop]->AddFd(fd, itor->second.events, itor->second.callbacks);
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("migrate fd %{public}d to loop %{public}u failed, return %{public}u", fd, toLoop, ret);
+        records_.erase(itor);
+    }
+}
+
+uint32_t EventLoopGroup::PostTask(uint32_t index, const Task& task)
+{
+    if (index >= loops_.size()) {
+        UTILS_LOGE("invalid loop %{public}u", index);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    loops_[index]->PostTask(task);
+    return TIMER_ERR_OK;
+}
+
+uint32_t EventLoopGroup::PostTaskToFd(int fd, const Task& task)
+{
+    int index = GetLoopIndex(fd);
+    if (index < 0) {
+        UTILS_LOGE("fd %{public}d not found", fd);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    loops_[index]->PostTask(task);
+    return TIMER_ERR_OK;
+}
+
+} // namespace Utils
+} // namespace OHOS
@@ -26,11 +26,17 @@
 namespace OHOS {
 namespace Utils {
 
-EventReactor::EventReactor()
-    :stopped_(true), demultiplexer_(new EventDemultiplexer())
+EventReactor::EventReactor(DemultiplexerBackend backend)
+    :stopped_(true), demultiplexer_(EventDemultiplexer::Create(backend)), loopThreadId_(),
+    statisticsEnabled_(false), slowHandler_(0), record_(new PollingRecord())
 {
 }
 
+DemultiplexerBackend EventReactor::GetBackend() const
+{
+    return demultiplexer_->GetBackend();
+}
+
 EventReactor::~EventReactor()
 {
 }
@@ -39,16 +45,21 @@ void EventReactor::RemoveEventHandler(EventHandler* handler)
 {
     if ((handler != nullptr) && (handler->GetEventReactor() == this) && (demultiplexer_ != nullptr)) {
         demultiplexer_->RemoveEventHandler(handler);
+        WakeupIfNotInLoop();
     }
 }
 
-void EventReactor::UpdateEventHandler(EventHandler* handler)
+uint32_t EventReactor::UpdateEventHandler(EventHandler* handler)
 {
-    if ((handler != nullptr) && (handler->GetEventReactor() == this) && (demultiplexer_ != nullptr)) {
-        if (demultiplexer_->UpdateEventHandler(handler) != 0) {
-            UTILS_LOGE("updateEventHandler failed.");
-        }
+    if ((handler == nullptr) || (handler->GetEventReactor() != this) || (demultiplexer_ == nullptr)) {
+        return TIMER_ERR_INVALID_VALUE;
     }
+    uint32_t ret = demultiplexer_->UpdateEventHandler(handler);
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("updateEventHandler failed.");
+    }
+    WakeupIfNotInLoop();
+    return ret;
 }
 
 uint32_t EventReactor::StartUp()
@@ -76,34 +87,129 @@ void EventReactor::CleanUp()
     }
 }
 
-void EventReactor::RunLoop(int timeout) const
+void EventReactor::RunLoop(int timeout)
 {
     if (demultiplexer_ == nullptr) {
         UTILS_LOGE("demultiplexer_ is nullptr.");
         return;
     }
+    loopThreadId_ = std::this_thread::get_id();
     while (!stopped_) {
-        demultiplexer_->Polling(timeout);
+        if (!statisticsEnabled_.load(std::memory_order_relaxed)) {
+            demultiplexer_->Polling(timeout);
+            RunPendingTasks();
+            continue;
+        }
+        uint64_t begin = EventDemultiplexer::MonotonicNow();
+        demultiplexer_->Polling(timeout, record_.get());
+        RunPendingTasks();
+        RecordIteration(EventDemultiplexer::MonotonicNow() - begin);
     }
+    loopThreadId_ = std::thread::id();
 }
 
 void EventReactor::StopLoop()
 {
     stopped_ = true;
+    if (demultiplexer_ != nullptr) {
+        demultiplexer_->Wakeup();
+    }
+}
+
+void EventReactor::PostTask(const Task& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        pendingTasks_.push_back(task);
+    }
+    if (demultiplexer_ != nullptr) {
+        demultiplexer_->Wakeup();
+    }
+}
+
+void EventReactor::RunPendingTasks()
+{
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        if (pendingTasks_.empty()) {
+            return;
+        }
+        tasks.swap(pendingTasks_);
+    }
+    for (const Task& task : tasks) {
+        task();
+    }
+}
+
+void EventReactor::EnableStatistics(bool enable, uint64_t slowHandler)
+{
+    slowHandler_ = slowHandler;
+    statisticsEnabled_ = enable;
+}
+
+ReactorStatistics EventReactor::GetStatistics()
+{
+    ReactorStatistics statistics;
+    {
+        std::lock_guard<std::mutex> lock(statisticsMutex_);
+        statistics = statistics_;
+    }
+    statistics.handlerCount = (demultiplexer_ != nullptr) ? demultiplexer_->GetHandlerCount() : 0;
+    return statistics;
+}
+
+void EventReactor::ResetStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    statistics_ = ReactorStatistics();
+}
+
+void EventReactor::RecordIteration(uint64_t iterationTime)
+{
+    const PollingRecord& record = *record_;
+    uint64_t slowHandler = slowHandler_;
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    statistics_.waitTime.Add(record.waitTime);
+    statistics_.dispatchTime.Add((iterationTime > record.waitTime) ? (iterationTime - record.waitTime) : 0);
+    statistics_.eventsPerWakeup.Add(record.events);
+    for (const auto& handlerDuration : record.handlerDurations) {
+        statistics_.handlerDuration.Add(handlerDuration.second);
+        if ((slowHandler != 0) && (handlerDuration.second > slowHandler)) {
+            statistics_.slowHandlers++;
+            UTILS_LOGI("slow handler of fd %{public}d took %{public}llu ns", handlerDuration.first,
+                static_cast<unsigned long long>(handlerDuration.second));
+        }
+    }
+}
+
+void EventReactor::WakeupIfNotInLoop()
+{
+    std::thread::id loopThreadId = loopThreadId_;
+    if ((loopThreadId != std::thread::id()) && (loopThreadId != std::this_thread::get_id())) {
+        demultiplexer_->Wakeup();
+    }
 }
 
 uint32_t EventReactor::ScheduleTimer(const TimerCallback& cb, uint32_t interval, int& timerFd, bool once)
+{
+    constexpr uint64_t milliToNano = 1000000;
+    return ScheduleTimer(cb, interval * milliToNano, 0, CLOCK_MONOTONIC, timerFd, once);
+}
+
+uint32_t EventReactor::ScheduleTimer(const TimerCallback& cb, uint64_t interval, uint64_t deadline,
+    clockid_t clockId, int& timerFd, bool once)
 {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
-    std::shared_ptr<TimerEventHandler> handler = std::make_shared<TimerEventHandler>(this, interval, once);
+    std::shared_ptr<TimerEventHandler> handler = std::make_shared<TimerEventHandler>(this, interval, once, clockId);
     if (handler == nullptr) {
         UTILS_LOGE("ScheduleTimer create TimerEventHandler failed.");
         return TIMER_ERR_INVALID_VALUE;
     }
     handler->SetTimerCallback(cb);
-    uint32_t ret = handler->Initialize();
+    uint32_t ret = handler->Initialize(deadline);
     if (ret != TIMER_ERR_OK) {
-        UTILS_LOGE("ScheduleTimer %{public}d initialize failed", interval);
+        UTILS_LOGE("ScheduleTimer %{public}llu ns initialize failed", static_cast<unsigned long long>(interval));
         return ret;
     }
 
@@ -112,6 +218,18 @@ uint32_t EventReactor::ScheduleTimer(const TimerCallback& cb, uint32_t interval,
     return TIMER_ERR_OK;
 }
 
+uint32_t EventReactor::RearmTimer(int timerFd, uint64_t deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    for (auto &itor : timerEventHandlers_) {
+        if (itor->GetTimerFd() == timerFd) {
+            return itor->Rearm(deadline);
+        }
+    }
+    UTILS_LOGE("Rearm timer, timerFd %{public}d not found.", timerFd);
+    return TIMER_ERR_INVALID_VALUE;
+}
+
 void EventReactor::CancelTimer(int timerFd)
 {
     UTILS_LOGD("Cancel timer, timerFd: %{public}d.", timerFd);
@@ -17,28 +17,55 @@
 #define UTILS_EVENT_REACTOR_H
 
 #include <sys/types.h>
+#include <ctime>
 #include <cstdint>
+#include <functional>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <list>
+#include <thread>
+#include <vector>
+
+#include "log2_histogram.h"
 
 namespace OHOS {
 namespace Utils {
 
 class EventDemultiplexer;
+struct PollingRecord;
+
+struct ReactorStatistics {
+    Log2Histogram waitTime;  // ns blocked waiting for events, per loop iteration
+    Log2Histogram dispatchTime;  // ns running event handlers and posted tasks, per loop iteration
+    Log2Histogram handlerDuration;  // ns of each EventHandler dispatch
+    Log2Histogram eventsPerWakeup;
+    uint64_t slowHandlers = 0;  // dispatches longer than the slow handler threshold
+    uint32_t handlerCount = 0;  // handlers registered when the snapshot is taken
+};
+
+/*
+ * kernel interface polling the fds of a reactor
+ * IO_URING: poll requests batched through io_uring, falls back to EPOLL where io_uring is not available
+ */
+enum class DemultiplexerBackend {
+    EPOLL,
+    IO_URING,
+};
 class EventHandler;
 class TimerEventHandler;
 
 class EventReactor {
 public:
-    using TimerCallback = std::function<void(int timerFd)>;
+    using TimerCallback = std::function<void(int timerFd, uint64_t expirations, uint64_t deadline /* ns */)>;
+    using Task = std::function<void()>;
     static const uint32_t NONE_EVENT  = 0x0000;
     static const uint32_t READ_EVENT  = 0x0001;
     static const uint32_t WRITE_EVENT = 0x0002;
     static const uint32_t CLOSE_EVENT = 0x0004;
     static const uint32_t ERROR_EVENT = 0x0008;
 
-    EventReactor();
+    explicit EventReactor(DemultiplexerBackend backend = DemultiplexerBackend::EPOLL);
     EventReactor(const EventReactor&) = delete;
     EventReactor& operator=(const EventReactor&) = delete;
     EventReactor(const EventReactor&&) = delete;
@@ -48,21 +75,57 @@ public:
     uint32_t StartUp();
     void CleanUp();
 
-    void RunLoop(int timeout) const;
+    /*
+     * timeout: -1 is recommended, StopLoop, PostTask and registration changes from
+     *          other threads wake the loop up immediately
+     */
+    void RunLoop(int timeout);
     void StopLoop();
     bool IsStopped() const { return stopped_; }
+    // the backend in use, may differ from the one asked for after fallback
+    DemultiplexerBackend GetBackend() const;
+    bool IsInLoopThread() const { return loopThreadId_.load() == std::this_thread::get_id(); }
+
+    // run task in the loop thread, tasks posted from the loop thread run after the current dispatch
+    void PostTask(const Task& task);
 
-    void UpdateEventHandler(EventHandler* handler);
+    uint32_t UpdateEventHandler(EventHandler* handler);
     void RemoveEventHandler(EventHandler* handler);
 
     uint32_t ScheduleTimer(const TimerCallback& cb, uint32_t interval /* ms */, int& timerFd, bool once);
+    /*
+     * deadline: absolute time(ns) of the first expiration on clockId, 0 means one interval from now
+     */
+    uint32_t ScheduleTimer(const TimerCallback& cb, uint64_t interval /* ns */, uint64_t deadline /* ns */,
+        clockid_t clockId, int& timerFd, bool once);
+    uint32_t RearmTimer(int timerFd, uint64_t deadline /* ns */);
     void CancelTimer(int timerFd);
 
+    /*
+     * statistics of the loop iterations, disabled by default, when disabled no clock is read
+     * slowHandler: dispatches taking longer are counted and logged with their fd, 0 means no threshold
+     */
+    void EnableStatistics(bool enable, uint64_t slowHandler /* ns */ = 0);
+    ReactorStatistics GetStatistics();
+    void ResetStatistics();
+
 private:
+    void RunPendingTasks();
+    void WakeupIfNotInLoop();
+    void RecordIteration(uint64_t iterationTime /* ns */);
+
     volatile bool stopped_;
     std::unique_ptr<EventDemultiplexer> demultiplexer_;
     std::recursive_mutex mutex_;
     std::list<std::shared_ptr<TimerEventHandler>> timerEventHandlers_;
+    std::atomic<std::thread::id> loopThreadId_;
+    std::mutex taskMutex_;
+    std::vector<Task> pendingTasks_; // guard by taskMutex_
+    std::atomic<bool> statisticsEnabled_;
+    std::atomic<uint64_t> slowHandler_;  // ns
+    std::unique_ptr<PollingRecord> record_;  // only touched by the loop thread, reused every iteration
+    std::mutex statisticsMutex_;
+    ReactorStatistics statistics_; // guard by statisticsMutex_
 };
 
 } // namespace Utils
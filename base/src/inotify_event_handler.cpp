@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "inotify_event_handler.h"
+#include "event_handler.h"
+#include "event_reactor.h"
+#include "common_timer_errors.h"
+#include "utils_log.h"
+
+#include <climits>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+namespace OHOS {
+namespace Utils {
+
+static const int INVALID_INOTIFY_FD = -1;
+// large enough for several events with the longest name
+static const size_t INOTIFY_BUFFER_SIZE = 16 * (sizeof(struct inotify_event) + NAME_MAX + 1);
+
+InotifyEventHandler::InotifyEventHandler(EventReactor* p)
+    : inotifyFd_(INVALID_INOTIFY_FD), reactor_(p), handler_(), callback_()
+{
+}
+
+InotifyEventHandler::~InotifyEventHandler()
+{
+    // the reactor keeps the handler until it is disabled
+    Uninitialize();
+    if (inotifyFd_ != INVALID_INOTIFY_FD) {
+        close(inotifyFd_);
+        inotifyFd_ = INVALID_INOTIFY_FD;
+    }
+}
+
+uint32_t InotifyEventHandler::Initialize()
+{
+    if (reactor_ == nullptr) {
+        UTILS_LOGE("InotifyEventHandler::initialize failed, reactor is null.");
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    if (inotifyFd_ == INVALID_INOTIFY_FD) {
+        inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ < 0) {
+            UTILS_LOGE("inotify_init1 failed.");
+            return TIMER_ERR_BADF;
+        }
+        handler_.reset(new EventHandler(inotifyFd_, reactor_));
+        handler_->SetReadCallback(std::bind(&InotifyEventHandler::ReadEvents, this));
+    }
+    return handler_->SetEvents(EventReactor::READ_EVENT);
+}
+
+void InotifyEventHandler::Uninitialize()
+{
+    if ((handler_ != nullptr) && (handler_->Events() != EventReactor::NONE_EVENT)) {
+        handler_->DisableAll();
+    }
+}
+
+int InotifyEventHandler::AddWatch(const std::string& path, uint32_t mask)
+{
+    if (inotifyFd_ == INVALID_INOTIFY_FD) {
+        UTILS_LOGE("inotify is not initialized.");
+        return -1;
+    }
+    int wd = inotify_add_watch(inotifyFd_, path.c_str(), mask);
+    if (wd < 0) {
+        UTILS_LOGE("watch %{public}s failed.", path.c_str());
+    }
+    return wd;
+}
+
+void InotifyEventHandler::RemoveWatch(int wd)
+{
+    if ((inotifyFd_ != INVALID_INOTIFY_FD) && (inotify_rm_watch(inotifyFd_, wd) != 0)) {
+        UTILS_LOGD("remove watch %{public}d failed.", wd);
+    }
+}
+
+void InotifyEventHandler::ReadEvents()
+{
+    alignas(struct inotify_event) char buffer[INOTIFY_BUFFER_SIZE];
+    while (true) {
+        ssize_t n = ::read(inotifyFd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            // EAGAIN, all queued events have been read
+            return;
+        }
+        for (char* ptr = buffer; ptr < buffer + n;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            if (callback_) {
+                std::string name = (event->len > 0) ? std::string(event->name) : std::string();
+                callback_(event->wd, event->mask, event->cookie, name);
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+} // namespace Utils
+} // namespace OHOS
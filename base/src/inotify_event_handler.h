@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_INOTIFY_EVENT_HANDLER_H
+#define UTILS_INOTIFY_EVENT_HANDLER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace OHOS {
+namespace Utils {
+
+class EventHandler;
+class EventReactor;
+
+/*
+ * file and directory changes delivered through one inotify instance in the reactor loop
+ */
+class InotifyEventHandler {
+    /*
+     * wd: watch descriptor returned by AddWatch
+     * mask: IN_* bits of the event
+     * cookie: pairs IN_MOVED_FROM with IN_MOVED_TO
+     * name: entry name inside a watched directory, empty for the watched path itself
+     */
+    using InotifyCallback = std::function<void(int wd, uint32_t mask, uint32_t cookie, const std::string& name)>;
+
+public:
+    explicit InotifyEventHandler(EventReactor* p);
+    ~InotifyEventHandler();
+
+    InotifyEventHandler(const InotifyEventHandler&) = delete;
+    InotifyEventHandler& operator=(const InotifyEventHandler&) = delete;
+    InotifyEventHandler(const InotifyEventHandler&&) = delete;
+    InotifyEventHandler& operator=(const InotifyEventHandler&&) = delete;
+
+    uint32_t Initialize();
+    void Uninitialize();
+
+    // mask: IN_CREATE, IN_DELETE, IN_MODIFY..., returns the watch descriptor, -1 if failed
+    int AddWatch(const std::string& path, uint32_t mask);
+    void RemoveWatch(int wd);
+
+    void SetInotifyCallback(const InotifyCallback& callback) { callback_ = callback; }
+    int GetInotifyFd() const { return inotifyFd_; }
+
+private:
+    void ReadEvents();
+
+private:
+    int            inotifyFd_;
+    EventReactor*  reactor_;
+
+    std::unique_ptr<EventHandler> handler_;
+    InotifyCallback callback_;
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io_uring_demultiplexer.h"
+#include "event_handler.h"
+#include "event_reactor.h"
+#include "common_timer_errors.h"
+#include "utils_log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+// multishot poll and timed waits need linux 5.13 headers, older ones build the epoll fallback only
+#if defined(IORING_FEAT_EXT_ARG) && defined(IORING_POLL_ADD_MULTI) && defined(__NR_io_uring_setup) && \
+    defined(__NR_io_uring_enter)
+#define UTILS_IO_URING_SUPPORTED
+#endif
+
+namespace OHOS {
+namespace Utils {
+
+static const int IO_URING_INVALID_FD = -1;
+
+IoUringDemultiplexer::IoUringDemultiplexer()
+    : EventDemultiplexer(false), ringFd_(IO_URING_INVALID_FD), sqEntries_(0), ring_(nullptr), ringSize_(0),
+      sqes_(nullptr), sqesSize_(0), sqHead_(nullptr), sqTail_(nullptr), sqMask_(nullptr), sqArray_(nullptr),
+      cqHead_(nullptr), cqTail_(nullptr), cqMask_(nullptr), cqes_(nullptr), slots_()
+{
+    if (!SetupRing()) {
+        UnmapRing();
+    }
+}
+
+IoUringDemultiplexer::~IoUringDemultiplexer()
+{
+    CleanUp();
+}
+
+DemultiplexerBackend IoUringDemultiplexer::GetBackend() const
+{
+    return DemultiplexerBackend::IO_URING;
+}
+
+uint32_t IoUringDemultiplexer::StartBackend()
+{
+    if (ringFd_ < 0) {
+        UTILS_LOGE("io_uring is not set up.");
+        return TIMER_ERR_BADF;
+    }
+    return TIMER_ERR_OK;
+}
+
+void IoUringDemultiplexer::CleanBackend()
+{
+    UnmapRing();
+}
+
+void IoUringDemultiplexer::UnmapRing()
+{
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqesSize_);
+        sqes_ = nullptr;
+    }
+    if (ring_ != nullptr) {
+        munmap(ring_, ringSize_);
+        ring_ = nullptr;
+    }
+    if (ringFd_ != IO_URING_INVALID_FD) {
+        close(ringFd_);
+        ringFd_ = IO_URING_INVALID_FD;
+    }
+}
+
+uint32_t IoUringDemultiplexer::Update(int operation, EventHandler* handler)
+{
+    int fd = handler->GetHandle();
+    if (fd < 0) {
+        UTILS_LOGE("invalid handle %{public}d.", fd);
+        return TIMER_ERR_BADF;
+    }
+    if (fd >= static_cast<int>(slots_.size())) {
+        slots_.resize(fd + 1, PollSlot{nullptr, 0, 0, 0, false});
+    }
+
+    // a changed registration always starts a new poll, completions of the old one are dropped by generation
+    PollSlot& slot = slots_[fd];
+    CancelPoll(fd, slot);
+    slot.generation++;
+    if (operation == EPOLL_CTL_DEL) {
+        slot.handler = nullptr;
+        slot.mask = 0;
+        return TIMER_ERR_OK;
+    }
+
+    slot.handler = handler;
+    slot.mask = Reactor2Epoll(handler->Events());
+    slot.triggerFlags = handler->TriggerFlags();
+    ArmPoll(fd, slot);
+    if ((slot.mask != 0) && !slot.armed) {
+        UTILS_LOGE("queue poll of handle %{public}d failed", fd);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    return TIMER_ERR_OK;
+}
+
+#ifdef UTILS_IO_URING_SUPPORTED
+
+static const uint32_t IO_URING_ENTRIES = 256;
+static const uint64_t IGNORED_USER_DATA = UINT64_MAX;  // completions of poll removals
+static const int MILLI_TO_BASE = 1000;
+static const long MILLI_TO_NANO = 1000000;
+static const int USER_DATA_GENERATION_SHIFT = 32;
+
+static uint64_t MakeUserData(int fd, uint32_t generation)
+{
+    return (static_cast<uint64_t>(generation) << USER_DATA_GENERATION_SHIFT) | static_cast<uint32_t>(fd);
+}
+
+bool IoUringDemultiplexer::SetupRing()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, IO_URING_ENTRIES, &params));
+    if (ringFd_ < 0) {
+        UTILS_LOGD("io_uring_setup failed, errno %{public}d.", errno);
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        UTILS_LOGD("io_uring features %{public}u not enough.", params.features);
+        return false;
+    }
+
+    ringSize_ = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+    void* ring = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+        IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        UTILS_LOGE("mmap io_uring rings failed.");
+        return false;
+    }
+    ring_ = ring;
+
+    sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        UTILS_LOGE("mmap io_uring sqes failed.");
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* base = static_cast<char*>(ring_);
+    sqEntries_ = params.sq_entries;
+    sqHead_ = reinterpret_cast<uint32_t*>(base + params.sq_off.head);
+    sqTail_ = reinterpret_cast<uint32_t*>(base + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<uint32_t*>(base + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<uint32_t*>(base + params.sq_off.array);
+    cqHead_ = reinterpret_cast<uint32_t*>(base + params.cq_off.head);
+    cqTail_ = reinterpret_cast<uint32_t*>(base + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<uint32_t*>(base + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(base + params.cq_off.cqes);
+    return true;
+}
+
+int IoUringDemultiplexer::Enter(uint32_t minComplete, int timeout /* ms */)
+{
+    uint32_t toSubmit = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    }
+
+    unsigned flags = (minComplete > 0) ? IORING_ENTER_GETEVENTS : 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    void* argp = nullptr;
+    size_t argSize = 0;
+    if ((minComplete > 0) && (timeout >= 0)) {
+        memset(&arg, 0, sizeof(arg));
+        ts.tv_sec = timeout / MILLI_TO_BASE;
+        ts.tv_nsec = static_cast<long>(timeout % MILLI_TO_BASE) * MILLI_TO_NANO;
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argSize = sizeof(arg);
+    }
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags, argp, argSize));
+}
+
+bool IoUringDemultiplexer::QueueSqe(const struct io_uring_sqe& sqe)
+{
+    uint32_t tail = *sqTail_;
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+        // ring full, submit now instead of at the next Polling
+        if ((Enter(0, 0) < 0) || (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)) {
+            UTILS_LOGE("io_uring submission ring is full, errno %{public}d.", errno);
+            return false;
+        }
+    }
+    uint32_t index = tail & *sqMask_;
+    sqes_[index] = sqe;
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void IoUringDemultiplexer::ArmPoll(int fd, PollSlot& slot)
+{
+    if ((slot.mask == 0) || (ringFd_ < 0)) {
+        return;
+    }
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_POLL_ADD;
+    sqe.fd = fd;
+    sqe.poll32_events = slot.mask;
+    if ((slot.triggerFlags & EventHandler::EDGE_TRIGGERED) && !(slot.triggerFlags & EventHandler::ONE_SHOT)) {
+        sqe.len = IORING_POLL_ADD_MULTI;
+    }
+    sqe.user_data = MakeUserData(fd, slot.generation);
+    slot.armed = QueueSqe(sqe);
+}
+
+void IoUringDemultiplexer::CancelPoll(int fd, PollSlot& slot)
+{
+    if (!slot.armed) {
+        return;
+    }
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_POLL_REMOVE;
+    sqe.fd = -1;
+    sqe.addr = MakeUserData(fd, slot.generation);
+    sqe.user_data = IGNORED_USER_DATA;
+    QueueSqe(sqe);
+    slot.armed = false;
+}
+
+bool IoUringDemultiplexer::HandleCompletion(const struct io_uring_cqe& cqe, EventHandler*& handler,
+    uint32_t& events)
+{
+    if (cqe.user_data == IGNORED_USER_DATA) {
+        return false;
+    }
+    int fd = static_cast<int>(cqe.user_data & UINT32_MAX);
+    uint32_t generation = static_cast<uint32_t>(cqe.user_data >> USER_DATA_GENERATION_SHIFT);
+
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (fd >= static_cast<int>(slots_.size())) {
+        return false;
+    }
+    PollSlot& slot = slots_[fd];
+    if ((slot.handler == nullptr) || (slot.generation != generation)) {
+        // removed or registered again after the poll was queued
+        return false;
+    }
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        // the poll is over, level triggered ones re-poll after every event, multishot ones if the kernel ended it
+        slot.armed = false;
+        if (!(slot.triggerFlags & EventHandler::ONE_SHOT)) {
+            ArmPoll(fd, slot);
+        }
+    }
+    if (cqe.res == -ECANCELED) {
+        return false;
+    }
+    handler = slot.handler;
+    // res is the poll mask, a multishot poll of an edge triggered fd reports IN and OUT in one completion
+    events = (cqe.res < 0) ? EventReactor::ERROR_EVENT : Epoll2Reactor(static_cast<uint32_t>(cqe.res));
+    return events != EventReactor::NONE_EVENT;
+}
+
+void IoUringDemultiplexer::Polling(int timeout /* ms */, PollingRecord* record)
+{
+    // submits the polls queued since the last call and waits in one syscall
+    uint64_t begin = (record != nullptr) ? MonotonicNow() : 0;
+    int ret = Enter(1, timeout);
+    if (record != nullptr) {
+        record->waitTime = MonotonicNow() - begin;
+        record->events = 0;
+        record->handlerDurations.clear();
+    }
+    if ((ret < 0) && (errno != ETIME) && (errno != EINTR)) {
+        UTILS_LOGE("io_uring_enter failed, errno %{public}d.", errno);
+        return;
+    }
+
+    uint32_t head = *cqHead_;
+    uint32_t tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe cqe = cqes_[head & *cqMask_];
+        head++;
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+        EventHandler* handler = nullptr;
+        uint32_t events = EventReactor::NONE_EVENT;
+        if (HandleCompletion(cqe, handler, events)) {
+            if (record != nullptr) {
+                record->events++;
+            }
+            Dispatch(handler, events, record);
+        }
+    }
+}
+
+#else
+
+bool IoUringDemultiplexer::SetupRing()
+{
+    UTILS_LOGD("io_uring is not supported by this build.");
+    return false;
+}
+
+int IoUringDemultiplexer::Enter(uint32_t minComplete, int timeout)
+{
+    (void)minComplete;
+    (void)timeout;
+    return -1;
+}
+
+bool IoUringDemultiplexer::QueueSqe(const struct io_uring_sqe& sqe)
+{
+    (void)sqe;
+    return false;
+}
+
+void IoUringDemultiplexer::ArmPoll(int fd, PollSlot& slot)
+{
+    (void)fd;
+    (void)slot;
+}
+
+void IoUringDemultiplexer::CancelPoll(int fd, PollSlot& slot)
+{
+    (void)fd;
+    slot.armed = false;
+}
+
+bool IoUringDemultiplexer::HandleCompletion(const struct io_uring_cqe& cqe, EventHandler*& handler,
+    uint32_t& events)
+{
+    (void)cqe;
+    (void)handler;
+    (void)events;
+    return false;
+}
+
+void IoUringDemultiplexer::Polling(int timeout, PollingRecord* record)
+{
+    (void)timeout;
+    (void)record;
+}
+
+#endif
+
+} // namespace Utils
+} // namespace OHOS
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_IO_URING_DEMULTIPLEXER_H
+#define UTILS_IO_URING_DEMULTIPLEXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "event_demultiplexer.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace OHOS {
+namespace Utils {
+
+/*
+ * EventDemultiplexer on io_uring, driven by raw syscalls.
+ * Poll requests are queued in the submission ring and submitted together with the wait of the next Polling,
+ * so registration changes and waiting cost one io_uring_enter instead of an epoll_ctl each.
+ * Edge triggered fds use multishot poll, level triggered and one shot fds a single poll re-armed after dispatch.
+ */
+class IoUringDemultiplexer : public EventDemultiplexer {
+public:
+    IoUringDemultiplexer();
+    ~IoUringDemultiplexer() override;
+
+    // false if the kernel or the build does not support io_uring
+    bool IsValid() const { return ringFd_ >= 0; }
+
+    DemultiplexerBackend GetBackend() const override;
+    void Polling(int timeout, PollingRecord* record = nullptr) override;
+
+protected:
+    uint32_t StartBackend() override;
+    void CleanBackend() override;
+    uint32_t Update(int operation, EventHandler* handler) override;
+
+private:
+    struct PollSlot {
+        EventHandler* handler;
+        uint32_t generation;  // bumped on every re-registration, completions of older polls are dropped
+        uint32_t mask;  // poll events, 0 if nothing is watched
+        uint32_t triggerFlags;
+        bool armed;  // a poll request is queued or in flight
+    };
+
+    bool SetupRing();
+    void UnmapRing();
+    bool QueueSqe(const io_uring_sqe& sqe);
+    void ArmPoll(int fd, PollSlot& slot);
+    void CancelPoll(int fd, PollSlot& slot);
+    int Enter(uint32_t minComplete, int timeout);
+    bool HandleCompletion(const io_uring_cqe& cqe, EventHandler*& handler, uint32_t& events);
+
+    int ringFd_;
+    uint32_t sqEntries_;
+    void* ring_;  // submission and completion rings share one mapping
+    size_t ringSize_;
+    io_uring_sqe* sqes_;
+    size_t sqesSize_;
+    uint32_t* sqHead_;
+    uint32_t* sqTail_;
+    uint32_t* sqMask_;
+    uint32_t* sqArray_;
+    uint32_t* cqHead_;
+    uint32_t* cqTail_;
+    uint32_t* cqMask_;
+    io_uring_cqe* cqes_;
+    std::vector<PollSlot> slots_;  // guard by mutex_, indexed by fd
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
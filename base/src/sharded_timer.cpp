@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sharded_timer.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "common_timer_errors.h"
+#include "utils_log.h"
+
+namespace OHOS {
+namespace Utils {
+
+ShardedTimer::ShardedTimer(const std::string& name, uint32_t shards, ShardPolicy policy, int timeoutMs,
+    clockid_t clockId) : name_(name), policy_(policy), shards_(), nextShard_(0), nextId_(1), stripes_()
+{
+    if (shards == 0) {
+        shards = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (uint32_t i = 0; i < shards; i++) {
+        shards_.emplace_back(new Timer(name + "_" + std::to_string(i), timeoutMs, clockId));
+    }
+}
+
+uint32_t ShardedTimer::Setup()
+{
+    for (size_t i = 0; i < shards_.size(); i++) {
+        uint32_t ret = shards_[i]->Setup();
+        if (ret != TIMER_ERR_OK) {
+            UTILS_LOGE("setup shard %{public}zu of %{public}s failed, return %{public}u", i, name_.c_str(), ret);
+            for (size_t j = 0; j < i; j++) {
+                shards_[j]->Shutdown();
+            }
+            return ret;
+        }
+    }
+    return TIMER_ERR_OK;
+}
+
+void ShardedTimer::Shutdown(bool useJoin)
+{
+    for (auto& shard : shards_) {
+        shard->Shutdown(useJoin);
+    }
+}
+
+uint32_t ShardedTimer::Register(const TimerCallback& callback, uint32_t interval /* ms */, bool once)
+{
+    return DoRegister(callback, once, [interval, once](Timer& shard, const TimerCallback& cb) {
+        return shard.Register(cb, interval, once);
+    });
+}
+
+uint32_t ShardedTimer::Register(const TimerCallback& callback, std::chrono::nanoseconds interval, bool once)
+{
+    return DoRegister(callback, once, [interval, once](Timer& shard, const TimerCallback& cb) {
+        return shard.Register(cb, interval, once);
+    });
+}
+
+uint32_t ShardedTimer::RegisterAt(const TimerCallback& callback, std::chrono::nanoseconds deadline,
+    std::chrono::nanoseconds interval)
+{
+    return DoRegister(callback, interval.count() == 0, [deadline, interval](Timer& shard, const TimerCallback& cb) {
+        return shard.RegisterAt(cb, deadline, interval);
+    });
+}
+
+uint32_t ShardedTimer::RegisterWithSlack(const TimerCallback& callback, std::chrono::nanoseconds interval,
+    std::chrono::nanoseconds slack, bool once)
+{
+    return DoRegister(callback, once, [interval, slack, once](Timer& shard, const TimerCallback& cb) {
+        return shard.RegisterWithSlack(cb, interval, slack, once);
+    });
+}
+
+void ShardedTimer::Unregister(uint32_t timerId)
+{
+    TimerLocation location;
+    if (!EraseId(timerId, location)) {
+        UTILS_LOGD("timer %{public}u does not exist", timerId);
+        return;
+    }
+    if (location.localId != 0) {
+        shards_[location.shard]->Unregister(location.localId);
+    }
+}
+
+uint32_t ShardedTimer::DoRegister(const TimerCallback& callback, bool once, const ShardRegister& shardRegister)
+{
+    uint32_t shard = PickShard();
+    uint32_t timerId = ReserveId(shard);
+
+    TimerCallback cb = callback;
+    if (once) {
+        // the shard forgets a once timer after it fires, so does the id table
+        cb = [this, timerId, callback]() {
+            callback();
+            TimerLocation location;
+            EraseId(timerId, location);
+        };
+    }
+
+    uint32_t localId = shardRegister(*shards_[shard], cb);
+    IdStripe& stripe = GetStripe(timerId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto itor = stripe.locations.find(timerId);
+    if (localId == TIMER_ERR_DEAL_FAILED) {
+        if (itor != stripe.locations.end()) {
+            stripe.locations.erase(itor);
+        }
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    // a once timer may have fired and gone already
+    if (itor != stripe.locations.end()) {
+        itor->second.localId = localId;
+    }
+    return timerId;
+}
+
+uint32_t ShardedTimer::PickShard()
+{
+    uint32_t shards = static_cast<uint32_t>(shards_.size());
+    if (policy_ == ShardPolicy::CALLER_THREAD) {
+        return static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) % shards);
+    }
+    return nextShard_.fetch_add(1, std::memory_order_relaxed) % shards;
+}
+
+/* valid range: [1, UINT32_MAX], but not TIMER_ERR_DEAL_FAILED, same as Timer */
+uint32_t ShardedTimer::ReserveId(uint32_t shard)
+{
+    while (true) {
+        uint32_t timerId = nextId_.fetch_add(1, std::memory_order_relaxed);
+        if ((timerId == 0) || (timerId == TIMER_ERR_DEAL_FAILED)) {
+            continue;
+        }
+        IdStripe& stripe = GetStripe(timerId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (stripe.locations.emplace(timerId, TimerLocation{shard, 0}).second) {
+            return timerId;
+        }
+        // still in use after the counter wraps around, try the next one
+    }
+}
+
+bool ShardedTimer::EraseId(uint32_t timerId, TimerLocation& location)
+{
+    IdStripe& stripe = GetStripe(timerId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto itor = stripe.locations.find(timerId);
+    if (itor == stripe.locations.end()) {
+        return false;
+    }
+    location = itor->second;
+    stripe.locations.erase(itor);
+    return true;
+}
+
+} // namespace Utils
+} // namespace OHOS
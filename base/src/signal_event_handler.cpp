@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal_event_handler.h"
+#include "event_handler.h"
+#include "event_reactor.h"
+#include "common_timer_errors.h"
+#include "utils_log.h"
+
+#include <unistd.h>
+
+namespace OHOS {
+namespace Utils {
+
+static const int INVALID_SIGNAL_FD = -1;
+static const int SIGNALS_PER_READ = 16;
+
+SignalEventHandler::SignalEventHandler(EventReactor* p)
+    : signalFd_(INVALID_SIGNAL_FD), mask_(), reactor_(p), handler_(), callback_()
+{
+    sigemptyset(&mask_);
+}
+
+SignalEventHandler::~SignalEventHandler()
+{
+    // the reactor keeps the handler until it is disabled
+    Uninitialize();
+    if (signalFd_ != INVALID_SIGNAL_FD) {
+        close(signalFd_);
+        signalFd_ = INVALID_SIGNAL_FD;
+    }
+}
+
+uint32_t SignalEventHandler::Initialize()
+{
+    if (reactor_ == nullptr) {
+        UTILS_LOGE("SignalEventHandler::initialize failed, reactor is null.");
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    if (signalFd_ == INVALID_SIGNAL_FD) {
+        signalFd_ = signalfd(-1, &mask_, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (signalFd_ < 0) {
+            UTILS_LOGE("signalfd failed.");
+            return TIMER_ERR_BADF;
+        }
+        handler_.reset(new EventHandler(signalFd_, reactor_));
+        handler_->SetReadCallback(std::bind(&SignalEventHandler::ReadSignals, this));
+    }
+    return handler_->SetEvents(EventReactor::READ_EVENT);
+}
+
+void SignalEventHandler::Uninitialize()
+{
+    if ((handler_ != nullptr) && (handler_->Events() != EventReactor::NONE_EVENT)) {
+        handler_->DisableAll();
+    }
+}
+
+uint32_t SignalEventHandler::AddSignal(int signo)
+{
+    if (sigaddset(&mask_, signo) != 0) {
+        UTILS_LOGE("invalid signal %{public}d.", signo);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    if ((signalFd_ != INVALID_SIGNAL_FD) && (signalfd(signalFd_, &mask_, 0) < 0)) {
+        UTILS_LOGE("update signalfd with signal %{public}d failed.", signo);
+        sigdelset(&mask_, signo);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    return TIMER_ERR_OK;
+}
+
+uint32_t SignalEventHandler::RemoveSignal(int signo)
+{
+    if (sigdelset(&mask_, signo) != 0) {
+        UTILS_LOGE("invalid signal %{public}d.", signo);
+        return TIMER_ERR_INVALID_VALUE;
+    }
+    if ((signalFd_ != INVALID_SIGNAL_FD) && (signalfd(signalFd_, &mask_, 0) < 0)) {
+        UTILS_LOGE("update signalfd without signal %{public}d failed.", signo);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    return TIMER_ERR_OK;
+}
+
+void SignalEventHandler::ReadSignals()
+{
+    struct signalfd_siginfo infos[SIGNALS_PER_READ];
+    while (true) {
+        ssize_t n = ::read(signalFd_, infos, sizeof(infos));
+        if (n <= 0) {
+            // EAGAIN, all pending signals have been read
+            return;
+        }
+        size_t count = static_cast<size_t>(n) / sizeof(infos[0]);
+        for (size_t i = 0; i < count; i++) {
+            if (callback_) {
+                callback_(infos[i]);
+            }
+        }
+    }
+}
+
+} // namespace Utils
+} // namespace OHOS
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_SIGNAL_EVENT_HANDLER_H
+#define UTILS_SIGNAL_EVENT_HANDLER_H
+
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sys/signalfd.h>
+
+namespace OHOS {
+namespace Utils {
+
+class EventHandler;
+class EventReactor;
+
+/*
+ * signals of a set delivered through one signalfd in the reactor loop.
+ * signalfd only sees signals that are blocked, block them with pthread_sigmask in every thread,
+ * in practice in the main thread before any other thread is created.
+ */
+class SignalEventHandler {
+    using SignalCallback = std::function<void(const struct signalfd_siginfo& info)>;
+
+public:
+    explicit SignalEventHandler(EventReactor* p);
+    ~SignalEventHandler();
+
+    SignalEventHandler(const SignalEventHandler&) = delete;
+    SignalEventHandler& operator=(const SignalEventHandler&) = delete;
+    SignalEventHandler(const SignalEventHandler&&) = delete;
+    SignalEventHandler& operator=(const SignalEventHandler&&) = delete;
+
+    uint32_t Initialize();
+    void Uninitialize();
+
+    uint32_t AddSignal(int signo);
+    uint32_t RemoveSignal(int signo);
+
+    void SetSignalCallback(const SignalCallback& callback) { callback_ = callback; }
+    int GetSignalFd() const { return signalFd_; }
+
+private:
+    void ReadSignals();
+
+private:
+    int            signalFd_;
+    sigset_t       mask_;
+    EventReactor*  reactor_;
+
+    std::unique_ptr<EventHandler> handler_;
+    SignalCallback callback_;
+};
+
+} // namespace Utils
+} // namespace OHOS
+#endif
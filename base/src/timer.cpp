@@ -24,13 +24,26 @@
 namespace OHOS {
 namespace Utils {
 
-Timer::Timer(const std::string& name, int timeoutMs) : name_(name), timeoutMs_(timeoutMs),
-    reactor_(new EventReactor())
+// Unit of measure conversion
+static const uint64_t MILLI_TO_NANO = 1000000;
+static const uint64_t NANO_TO_BASE = 1000000000;
+
+Timer::Timer(const std::string& name, int timeoutMs, clockid_t clockId) : slackTimerFd_(INVALID_TIMER_FD),
+    maxSlack_(0), savedWakeups_(0), name_(name), timeoutMs_(timeoutMs), clockId_(clockId),
+    reactor_(new EventReactor()), statisticsEnabled_(false)
 {
 }
 
 uint32_t Timer::Setup()
 {
+    // start up in the caller thread, so that a Shutdown right after Setup always finds the loop running
+    uint32_t ret = reactor_->StartUp();
+    if (ret != TIMER_ERR_OK) {
+        UTILS_LOGE("reactor start up failed, return %{public}u", ret);
+        reactor_->CleanUp();
+        return ret;
+    }
+
     std::thread loop_thread(std::bind(&Timer::MainLoop, this));
     thread_.swap(loop_thread);
 
@@ -45,14 +58,6 @@ void Timer::Shutdown(bool useJoin)
     }
 
     reactor_->StopLoop();
-    if (timeoutMs_ == -1) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (intervalToTimers_.empty()) {
-            UTILS_LOGI("no event for epoll wait, use detach to shutdown");
-            thread_.detach();
-            return;
-        }
-    }
     if (!useJoin) {
         thread_.detach();
         return;
@@ -62,34 +67,111 @@ void Timer::Shutdown(bool useJoin)
 
 uint32_t Timer::Register(const TimerCallback& callback, uint32_t interval /* ms */, bool once)
 {
+    return DoRegisterEntry(callback, interval * MILLI_TO_NANO, 0, once);
+}
+
+uint32_t Timer::Register(const TimerCallback& callback, std::chrono::nanoseconds interval, bool once)
+{
+    if (interval.count() < 0) {
+        UTILS_LOGE("invalid interval %{public}lld ns", static_cast<long long>(interval.count()));
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    return DoRegisterEntry(callback, static_cast<uint64_t>(interval.count()), 0, once);
+}
+
+uint32_t Timer::RegisterAt(const TimerCallback& callback, std::chrono::nanoseconds deadline,
+    std::chrono::nanoseconds interval)
+{
+    if (interval.count() < 0) {
+        UTILS_LOGE("invalid interval %{public}lld ns", static_cast<long long>(interval.count()));
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    // deadline 0 means "relative" inside, a deadline not after the epoch of the clock is already expired anyway
+    uint64_t absDeadline = (deadline.count() > 0) ? static_cast<uint64_t>(deadline.count()) : 1;
+    return DoRegisterEntry(callback, static_cast<uint64_t>(interval.count()), absDeadline, interval.count() == 0);
+}
+
+uint32_t Timer::RegisterWithSlack(const TimerCallback& callback, std::chrono::nanoseconds interval,
+    std::chrono::nanoseconds slack, bool once)
+{
+    if ((interval.count() <= 0) || (slack.count() < 0)) {
+        UTILS_LOGE("invalid interval %{public}lld ns or slack %{public}lld ns",
+            static_cast<long long>(interval.count()), static_cast<long long>(slack.count()));
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    if (slack.count() == 0) {
+        return Register(callback, interval, once);
+    }
+
+    uint64_t now = static_cast<uint64_t>(Now().count());
     std::lock_guard<std::mutex> lock(mutex_);
-    static std::atomic_uint32_t timerId = 1;
-    int timerFd = once ? INVALID_TIMER_FD : GetTimerFd(interval);
+    TimerEntryPtr entry(new TimerEntry());
+    entry->timerId = GetNextTimerId();
+    entry->interval = static_cast<uint64_t>(interval.count());
+    entry->callback = callback;
+    entry->once = once;
+    entry->absolute = false;
+    entry->slack = static_cast<uint64_t>(slack.count());
+    entry->deadline = now + entry->interval;
+
+    auto itor = slackTimers_.emplace(entry->deadline + entry->slack, entry);
+    maxSlack_ = std::max(maxSlack_, entry->slack);
+    if (RearmSlackTimer() != TIMER_ERR_OK) {
+        UTILS_LOGE("register slack timer failed");
+        slackTimers_.erase(itor);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    entry->timerFd = slackTimerFd_;
+    timerToEntries_[entry->timerId] = entry;
+
+    UTILS_LOGD("register timer %{public}u with %{public}llu ns interval, %{public}llu ns slack.", entry->timerId,
+        static_cast<unsigned long long>(entry->interval), static_cast<unsigned long long>(entry->slack));
+    return entry->timerId;
+}
+
+std::chrono::nanoseconds Timer::Now() const
+{
+    timespec now{0, 0};
+    if (clock_gettime(clockId_, &now) == -1) {
+        UTILS_LOGE("Failed clock_gettime.");
+        return std::chrono::nanoseconds::zero();
+    }
+    return std::chrono::nanoseconds(static_cast<uint64_t>(now.tv_sec) * NANO_TO_BASE +
+        static_cast<uint64_t>(now.tv_nsec));
+}
+
+uint32_t Timer::DoRegisterEntry(const TimerCallback& callback, uint64_t interval /* ns */, uint64_t deadline /* ns */,
+    bool once)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool absolute = (deadline != 0);
+    // only relative periodic timers with the same interval are in phase and can share one timerFd
+    int timerFd = (once || absolute) ? INVALID_TIMER_FD : GetTimerFd(interval);
     if (timerFd == INVALID_TIMER_FD) {
-        uint32_t ret = DoRegister(std::bind(&Timer::OnTimer, this, std::placeholders::_1), interval, once, timerFd);
+        using namespace std::placeholders;
+        uint32_t ret = DoRegister(std::bind(&Timer::OnTimer, this, _1, _2, _3), interval, deadline, once, timerFd);
         if (ret != TIMER_ERR_OK) {
-            UTILS_LOGE("do register interval timer %{public}d failed, return %{public}u", interval, ret);
+            UTILS_LOGE("do register interval timer %{public}llu ns failed, return %{public}u",
+                static_cast<unsigned long long>(interval), ret);
             return TIMER_ERR_DEAL_FAILED;
         }
     }
 
-    timerId = GetValidId(timerId);
-    while (timerToEntries_.find(timerId) != timerToEntries_.end()) {
-        timerId++;
-        timerId = GetValidId(timerId);
-    }
-
     TimerEntryPtr entry(new TimerEntry());
-    entry->timerId = timerId++;
+    entry->timerId = GetNextTimerId();
     entry->interval = interval;
     entry->callback = callback;
     entry->once = once;
+    entry->absolute = absolute;
     entry->timerFd = timerFd;
+    entry->slack = 0;
+    entry->deadline = 0;
 
     intervalToTimers_[interval].push_back(entry);
     timerToEntries_[entry->timerId] = entry;
 
-    UTILS_LOGD("register timer %{public}u with %{public}u ms interval.", entry->timerId, entry->interval);
+    UTILS_LOGD("register timer %{public}u with %{public}llu ns interval.", entry->timerId,
+        static_cast<unsigned long long>(entry->interval));
     return entry->timerId;
 }
 
@@ -102,13 +184,27 @@ void Timer::Unregister(uint32_t timerId)
     }
 
     auto entry = timerToEntries_[timerId];
-    UTILS_LOGD("deregister timer %{public}u with %{public}u ms interval", timerId, entry->interval);
+    UTILS_LOGD("deregister timer %{public}u with %{public}llu ns interval", timerId,
+        static_cast<unsigned long long>(entry->interval));
+
+    if (entry->slack != 0) {
+        auto range = slackTimers_.equal_range(entry->deadline + entry->slack);
+        for (auto itor = range.first; itor != range.second; ++itor) {
+            if (itor->second == entry) {
+                slackTimers_.erase(itor);
+                break;
+            }
+        }
+        timerToEntries_.erase(timerId);
+        RearmSlackTimer();
+        return;
+    }
 
     auto itor = intervalToTimers_[entry->interval].begin();
     for (; itor != intervalToTimers_[entry->interval].end(); ++itor) {
         if ((*itor)->timerId == timerId) {
             UTILS_LOGD("erase timer %{public}u.", timerId);
-            if ((*itor)->once) {
+            if ((*itor)->once || (*itor)->absolute) {
                 reactor_->CancelTimer((*itor)->timerFd);
                 timers_.erase((*itor)->timerFd);
             }
@@ -118,7 +214,7 @@ void Timer::Unregister(uint32_t timerId)
     }
 
     if (intervalToTimers_[entry->interval].empty()) {
-        UTILS_LOGD("deregister timer interval: %{public}u.", entry->interval);
+        UTILS_LOGD("deregister timer interval: %{public}llu ns.", static_cast<unsigned long long>(entry->interval));
         intervalToTimers_.erase(entry->interval);
         DoUnregister(entry->interval);
     }
@@ -128,17 +224,16 @@ void Timer::Unregister(uint32_t timerId)
 void Timer::MainLoop()
 {
     prctl(PR_SET_NAME, name_.c_str(), 0, 0, 0);
-    if (reactor_->StartUp() == TIMER_ERR_OK) {
-        reactor_->RunLoop(timeoutMs_);
-    }
+    reactor_->RunLoop(timeoutMs_);
     reactor_->CleanUp();
 }
 
-uint32_t Timer::DoRegister(const TimerListCallback& callback, uint32_t interval, bool once, int &timerFd)
+uint32_t Timer::DoRegister(const TimerListCallback& callback, uint64_t interval, uint64_t deadline, bool once,
+    int &timerFd)
 {
     using namespace std::placeholders;
-    std::function<void(int)> cb = std::bind(&Timer::DoTimerListCallback, this, callback, _1);
-    uint32_t ret = reactor_->ScheduleTimer(cb, interval, timerFd, once);
+    EventReactor::TimerCallback cb = std::bind(&Timer::DoTimerListCallback, this, callback, _1, _2, _3);
+    uint32_t ret = reactor_->ScheduleTimer(cb, interval, deadline, clockId_, timerFd, once);
     if ((ret != TIMER_ERR_OK) || (timerFd < 0)) {
         UTILS_LOGE("ScheduleTimer failed!ret:%{public}d, timerFd:%{public}d", ret, timerFd);
         return ret;
@@ -147,7 +242,7 @@ uint32_t Timer::DoRegister(const TimerListCallback& callback, uint32_t interval,
     return TIMER_ERR_OK;
 }
 
-void Timer::DoUnregister(uint32_t interval)
+void Timer::DoUnregister(uint64_t interval)
 {
     for (auto& itor : timers_) {
         if (itor.second == interval) {
@@ -156,9 +251,9 @@ void Timer::DoUnregister(uint32_t interval)
     }
 }
 
-void Timer::OnTimer(int timerFd)
+void Timer::OnTimer(int timerFd, uint64_t expirations, uint64_t deadline)
 {
-    uint32_t interval = timers_[timerFd];
+    uint64_t interval = timers_[timerFd];
     TimerEntryList entryList;
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -172,7 +267,7 @@ void Timer::OnTimer(int timerFd)
         }
         /* if stop, callback is forbidden */
         if (!reactor_->IsStopped()) {
-            ptr->callback();
+            DoTimerCallback(ptr, expirations - 1, deadline);
         }
 
         if (!ptr->once) {
@@ -186,9 +281,140 @@ void Timer::OnTimer(int timerFd)
     }
 }
 
-void Timer::DoTimerListCallback(const TimerListCallback& callback, int timerFd)
+void Timer::OnSlackTimer(int timerFd, uint64_t expirations, uint64_t deadline)
+{
+    (void)timerFd;
+    (void)expirations;
+    (void)deadline;
+    std::vector<TimerEntryPtr> expired;
+    std::vector<uint64_t> deadlines;
+    std::vector<uint64_t> missed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = static_cast<uint64_t>(Now().count());
+        // windows ending after now + maxSlack_ cannot have opened yet
+        auto itor = slackTimers_.begin();
+        while ((itor != slackTimers_.end()) && (itor->first <= now + maxSlack_)) {
+            if (itor->second->deadline > now) {
+                ++itor;
+                continue;
+            }
+            expired.push_back(itor->second);
+            itor = slackTimers_.erase(itor);
+        }
+
+        for (const TimerEntryPtr& ptr : expired) {
+            deadlines.push_back(ptr->deadline);
+            if (ptr->once) {
+                missed.push_back(0);
+                timerToEntries_.erase(ptr->timerId);
+                continue;
+            }
+            // keep the phase, skip the periods missed
+            uint64_t periods = 0;
+            do {
+                ptr->deadline += ptr->interval;
+                periods++;
+            } while (ptr->deadline <= now);
+            missed.push_back(periods - 1);
+            slackTimers_.emplace(ptr->deadline + ptr->slack, ptr);
+        }
+        if (expired.size() > 1) {
+            savedWakeups_ += expired.size() - 1;
+        }
+        RearmSlackTimer();
+    }
+
+    for (size_t i = 0; i < expired.size(); i++) {
+        /* if stop, callback is forbidden */
+        if (!reactor_->IsStopped()) {
+            DoTimerCallback(expired[i], missed[i], deadlines[i]);
+        }
+    }
+}
+
+/* call with mutex_ held */
+uint32_t Timer::RearmSlackTimer()
+{
+    // wake up at the earliest end of all windows, every slack timer whose window has opened by then fires together
+    uint64_t wakeup = slackTimers_.empty() ? 0 : slackTimers_.begin()->first;
+    if (slackTimerFd_ != INVALID_TIMER_FD) {
+        return reactor_->RearmTimer(slackTimerFd_, wakeup);
+    }
+    if (wakeup == 0) {
+        return TIMER_ERR_OK;
+    }
+
+    int timerFd = INVALID_TIMER_FD;
+    using namespace std::placeholders;
+    uint32_t ret = reactor_->ScheduleTimer(std::bind(&Timer::OnSlackTimer, this, _1, _2, _3), 0, wakeup, clockId_,
+        timerFd, true);
+    if ((ret != TIMER_ERR_OK) || (timerFd < 0)) {
+        UTILS_LOGE("ScheduleTimer failed!ret:%{public}d, timerFd:%{public}d", ret, timerFd);
+        return TIMER_ERR_DEAL_FAILED;
+    }
+    slackTimerFd_ = timerFd;
+    return TIMER_ERR_OK;
+}
+
+void Timer::DoTimerListCallback(const TimerListCallback& callback, int timerFd, uint64_t expirations,
+    uint64_t deadline)
+{
+    callback(timerFd, expirations, deadline);
+}
+
+void Timer::DoTimerCallback(const TimerEntryPtr& entry, uint64_t missed, uint64_t deadline)
+{
+    if (!statisticsEnabled_.load(std::memory_order_relaxed)) {
+        entry->callback();
+        return;
+    }
+
+    uint64_t start = static_cast<uint64_t>(Now().count());
+    entry->callback();
+    uint64_t end = static_cast<uint64_t>(Now().count());
+    uint64_t lateness = (start > deadline) ? (start - deadline) : 0;
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    if (entry->statistics == nullptr) {
+        entry->statistics = std::make_shared<TimerStatistics>();
+    }
+    for (TimerStatistics* statistics : {entry->statistics.get(), &statistics_}) {
+        statistics->lateness.Add(lateness);
+        statistics->callbackDuration.Add(end - start);
+        statistics->missedExpirations.Add(missed);
+    }
+}
+
+TimerStatistics Timer::GetStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    return statistics_;
+}
+
+bool Timer::GetStatistics(uint32_t timerId, TimerStatistics& statistics)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itor = timerToEntries_.find(timerId);
+    if (itor == timerToEntries_.end()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> statisticsLock(statisticsMutex_);
+    if (itor->second->statistics == nullptr) {
+        return false;
+    }
+    statistics = *(itor->second->statistics);
+    return true;
+}
+
+void Timer::ResetStatistics()
 {
-    callback(timerFd);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> statisticsLock(statisticsMutex_);
+    statistics_ = TimerStatistics();
+    for (auto& itor : timerToEntries_) {
+        itor.second->statistics.reset();
+    }
 }
 
 /* valid range: [1, UINT32_MAX], but not TIMER_ERR_DEAL_FAILED */
@@ -203,21 +429,33 @@ uint32_t Timer::GetValidId(uint32_t timerId) const
     return timerId;
 }
 
-int Timer::GetTimerFd(uint32_t interval /* ms */)
+/* call with mutex_ held */
+uint32_t Timer::GetNextTimerId()
+{
+    static std::atomic_uint32_t timerId = 1;
+    timerId = GetValidId(timerId);
+    while (timerToEntries_.find(timerId) != timerToEntries_.end()) {
+        timerId++;
+        timerId = GetValidId(timerId);
+    }
+    return timerId++;
+}
+
+int Timer::GetTimerFd(uint64_t interval /* ns */)
 {
     if (intervalToTimers_.find(interval) == intervalToTimers_.end()) {
         return INVALID_TIMER_FD;
     }
     auto &entryList = intervalToTimers_[interval];
     for (const TimerEntryPtr &ptr : entryList) {
-        if (!ptr->once) {
+        if (!ptr->once && !ptr->absolute) {
             return ptr->timerFd;
         }
     }
     return INVALID_TIMER_FD;
 }
 
-void Timer::EraseUnusedTimerId(uint32_t interval, const std::vector<uint32_t>& unusedIds)
+void Timer::EraseUnusedTimerId(uint64_t interval, const std::vector<uint32_t>& unusedIds)
 {
     std::lock_guard<std::mutex> lock(mutex_);
     auto &entryList = intervalToTimers_[interval];
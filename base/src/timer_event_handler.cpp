@@ -26,14 +26,22 @@ namespace OHOS {
 namespace Utils {
 
 // Unit of measure conversion
-static const int MILLI_TO_BASE = 1000;
-static const int NANO_TO_BASE = 1000000000;
-constexpr int MILLI_TO_NANO = NANO_TO_BASE / MILLI_TO_BASE;
+static const uint64_t NANO_TO_BASE = 1000000000;
 
-TimerEventHandler::TimerEventHandler(EventReactor* p, uint32_t timeout /* ms */, bool once)
+static timespec NanoToTimespec(uint64_t nanoSeconds)
+{
+    timespec ts{0, 0};
+    ts.tv_sec = static_cast<time_t>(nanoSeconds / NANO_TO_BASE);
+    ts.tv_nsec = static_cast<long>(nanoSeconds % NANO_TO_BASE);
+    return ts;
+}
+
+TimerEventHandler::TimerEventHandler(EventReactor* p, uint64_t interval /* ns */, bool once, clockid_t clockId)
     : once_(once),
-      timerFd_(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
-      interval_(timeout),
+      clockId_(clockId),
+      timerFd_(timerfd_create(clockId, TFD_NONBLOCK | TFD_CLOEXEC)),
+      interval_(interval),
+      nextDeadline_(0),
       reactor_(p),
       handler_(new EventHandler(timerFd_, p)),
       callback_()
@@ -46,45 +54,52 @@ TimerEventHandler::~TimerEventHandler()
     timerFd_ = INVALID_TIMER_FD;
 }
 
-uint32_t TimerEventHandler::Initialize()
+uint32_t TimerEventHandler::Initialize(uint64_t deadline /* ns */)
 {
     if ((timerFd_ == INVALID_TIMER_FD) || (reactor_ == nullptr) || (handler_ == nullptr)) {
         UTILS_LOGE("TimerEventHandler::initialize failed.");
         return TIMER_ERR_INVALID_VALUE;
     }
 
-    struct itimerspec newValue = {{0, 0}, {0, 0}};
-    timespec now{0, 0};
-    if (clock_gettime(CLOCK_MONOTONIC, &now) == -1) {
-        UTILS_LOGE("Failed clock_gettime.");
-        return TIMER_ERR_DEAL_FAILED;
+    if (deadline == 0) {
+        timespec now{0, 0};
+        if (clock_gettime(clockId_, &now) == -1) {
+            UTILS_LOGE("Failed clock_gettime.");
+            return TIMER_ERR_DEAL_FAILED;
+        }
+        // next time out time is now + interval
+        deadline = static_cast<uint64_t>(now.tv_sec) * NANO_TO_BASE + static_cast<uint64_t>(now.tv_nsec) + interval_;
     }
 
-    // next time out time is now + interval
-    newValue.it_value.tv_sec = now.tv_sec + interval_ / MILLI_TO_BASE;
-    newValue.it_value.tv_nsec = now.tv_nsec + (interval_ % MILLI_TO_BASE) * MILLI_TO_NANO;
-    if (newValue.it_value.tv_nsec >= NANO_TO_BASE) {
-        newValue.it_value.tv_sec += 1;
-        newValue.it_value.tv_nsec = newValue.it_value.tv_nsec % NANO_TO_BASE;
+    uint32_t ret = Rearm(deadline);
+    if (ret != TIMER_ERR_OK) {
+        return ret;
     }
 
-    if (once_) {
-        // interval, 0 means time out only once
-        newValue.it_interval.tv_sec  = 0;
-        newValue.it_interval.tv_nsec = 0;
-    } else {
-        // interval
-        newValue.it_interval.tv_sec  = interval_ / MILLI_TO_BASE;
-        newValue.it_interval.tv_nsec = (interval_ % MILLI_TO_BASE) * MILLI_TO_NANO;
+    handler_->SetReadCallback(std::bind(&TimerEventHandler::TimeOut, this));
+    handler_->EnableRead();
+    return TIMER_ERR_OK;
+}
+
+uint32_t TimerEventHandler::Rearm(uint64_t deadline /* ns */)
+{
+    if (timerFd_ == INVALID_TIMER_FD) {
+        UTILS_LOGE("timerFd_ is invalid.");
+        return TIMER_ERR_INVALID_VALUE;
+    }
+
+    struct itimerspec newValue = {{0, 0}, {0, 0}};
+    newValue.it_value = NanoToTimespec(deadline);
+    if (!once_) {
+        // interval, keep it 0 to time out only once
+        newValue.it_interval = NanoToTimespec(interval_);
     }
 
     if (timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &newValue, nullptr) == -1) {
         UTILS_LOGE("Failed in timerFd_settime");
         return TIMER_ERR_DEAL_FAILED;
     }
-
-    handler_->SetReadCallback(std::bind(&TimerEventHandler::TimeOut, this));
-    handler_->EnableRead();
+    nextDeadline_ = deadline;
     return TIMER_ERR_OK;
 }
 
@@ -105,9 +120,17 @@ void TimerEventHandler::TimeOut()
     ssize_t n = ::read(timerFd_, &expirations, sizeof(expirations));
     if (n != sizeof(expirations)) {
         UTILS_LOGE("epoll_loop::on_timer() reads %{public}d bytes instead of 8.", static_cast<int>(n));
+        return;
+    }
+
+    // timerfd keeps the schedule, expiration k is at the first deadline + k * interval
+    uint64_t deadline = nextDeadline_;
+    if (!once_ && (expirations > 1)) {
+        deadline += (expirations - 1) * interval_;
     }
+    nextDeadline_ = once_ ? 0 : deadline + interval_;
     if (callback_) {
-        callback_(timerFd_);
+        callback_(timerFd_, expirations, deadline);
     }
 }
 
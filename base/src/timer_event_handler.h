@@ -15,6 +15,7 @@
 #ifndef UTILS_TIMER_EVENT_HANDLER_H
 #define UTILS_TIMER_EVENT_HANDLER_H
 
+#include <ctime>
 #include <functional>
 #include <memory>
 #include <cstdint>
@@ -27,10 +28,18 @@ class EventHandler;
 class EventReactor;
 
 class TimerEventHandler {
-    using TimerCallback = std::function<void(int timerFd)>;
+    /*
+     * expirations: expirations read from timerFd, more than 1 means some were missed
+     * deadline: scheduled time(ns) of the latest expiration
+     */
+    using TimerCallback = std::function<void(int timerFd, uint64_t expirations, uint64_t deadline)>;
     
 public:
-    TimerEventHandler(EventReactor* p, uint32_t timeout, bool once);
+    /*
+     * interval: period of the timer in nanoseconds, on the clock given by clockId
+     * clockId:  CLOCK_MONOTONIC(default), CLOCK_BOOTTIME or CLOCK_REALTIME
+     */
+    TimerEventHandler(EventReactor* p, uint64_t interval /* ns */, bool once, clockid_t clockId = CLOCK_MONOTONIC);
     ~TimerEventHandler();
 
     TimerEventHandler(const TimerEventHandler&) = delete;
@@ -38,12 +47,23 @@ public:
     TimerEventHandler(const TimerEventHandler&&) = delete;
     TimerEventHandler& operator=(const TimerEventHandler&&) = delete;
 
-    uint32_t Initialize();
+    /*
+     * deadline: absolute time(ns) of the first expiration on the timer clock,
+     *           0 means one interval from now
+     */
+    uint32_t Initialize(uint64_t deadline = 0 /* ns */);
     void Uninitialize();
 
+    /*
+     * move the next expiration to an absolute deadline(ns), 0 disarms the timer
+     * the timer must have been initialized
+     */
+    uint32_t Rearm(uint64_t deadline /* ns */);
+
     void SetTimerCallback(const TimerCallback& callback) { callback_ = callback; }
 
-    uint32_t GetInterval() const { return interval_; }
+    uint64_t GetInterval() const { return interval_; }
+    clockid_t GetClockId() const { return clockId_; }
     int GetTimerFd() const { return timerFd_; }
 
 private:
@@ -51,8 +71,10 @@ private:
 
 private:
     bool           once_;
+    clockid_t      clockId_;
     int            timerFd_;
-    uint32_t       interval_;
+    uint64_t       interval_;  // ns
+    uint64_t       nextDeadline_;  // ns
     EventReactor*  reactor_;
 
     std::unique_ptr<EventHandler> handler_;
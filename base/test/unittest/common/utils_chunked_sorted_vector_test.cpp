@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "chunked_sorted_vector.h"
+#include "sorted_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsChunkedSortedVector : public testing::Test {
+};
+
+namespace {
+template <class Chunked>
+void ExpectSameItems(const Chunked& chunked, const vector<int>& expected)
+{
+    ASSERT_EQ(expected.size(), chunked.Size());
+    size_t i = 0;
+    for (auto it = chunked.Begin(); it != chunked.End(); ++it, ++i) {
+        ASSERT_EQ(expected[i], *it);
+        ASSERT_EQ(expected[i], chunked[i]);
+    }
+    ASSERT_EQ(expected.size(), i);
+}
+} // namespace
+
+/*
+ * @tc.name: testChunkedSortedVector001
+ * @tc.desc: Add, IndexOf, OrderOf and operator[] agree with SortedVector across many chunk splits
+ */
+HWTEST_F(UtilsChunkedSortedVector, testChunkedSortedVector001, TestSize.Level0)
+{
+    ChunkedSortedVector<int> chunked;
+    SortedVector<int> svec;
+    ASSERT_TRUE(chunked.IsEmpty());
+    ssize_t notFound = ChunkedSortedVector<int>::NOT_FOUND;
+    ASSERT_EQ(notFound, chunked.IndexOf(1));
+    ASSERT_EQ(0u, chunked.OrderOf(1));
+
+    mt19937 random(1);
+    uniform_int_distribution<int> values(0, 2000);
+    for (int i = 0; i < 20000; i++) {
+        int value = values(random);
+        ASSERT_EQ(svec.Add(value), chunked.Add(value));
+    }
+    ExpectSameItems(chunked, vector<int>(svec.Begin(), svec.End()));
+    for (int value = -1; value <= 2001; value++) {
+        ASSERT_EQ(svec.IndexOf(value), chunked.IndexOf(value));
+        ASSERT_EQ(svec.OrderOf(value), chunked.OrderOf(value));
+    }
+    ASSERT_EQ(svec.Front(), chunked.Front());
+    ASSERT_EQ(svec.Back(), chunked.Back());
+
+    chunked.Clear();
+    ASSERT_TRUE(chunked.IsEmpty());
+    ASSERT_TRUE(chunked.Begin() == chunked.End());
+}
+
+/*
+ * @tc.name: testChunkedSortedVector002
+ * @tc.desc: no duplicates, Erase down to empty and Merge
+ */
+HWTEST_F(UtilsChunkedSortedVector, testChunkedSortedVector002, TestSize.Level0)
+{
+    ChunkedSortedVector<int, false> chunked;
+    vector<int> expected;
+    for (int i = 9999; i >= 0; i--) {
+        ASSERT_EQ(0, chunked.Add(i * 2));
+    }
+    for (int i = 0; i < 10000; i++) {
+        expected.push_back(i * 2);
+    }
+    ssize_t addFail = ChunkedSortedVector<int, false>::ADD_FAIL;
+    ASSERT_EQ(addFail, chunked.Add(100));
+    ExpectSameItems(chunked, expected);
+
+    // erase every third item, the returned iterator points to the item after it
+    for (size_t i = 0; i < expected.size(); i += 2) {
+        auto next = chunked.Erase(i);
+        expected.erase(expected.begin() + i);
+        if (i < expected.size()) {
+            ASSERT_EQ(expected[i], *next);
+        } else {
+            ASSERT_TRUE(next == chunked.End());
+        }
+    }
+    ExpectSameItems(chunked, expected);
+    ASSERT_TRUE(chunked.Erase(chunked.Size()) == chunked.End());
+
+    // odd values are new, the even ones already there are dropped
+    vector<int> more;
+    for (int i = 0; i < 20000; i++) {
+        more.push_back(i);
+    }
+    shuffle(more.begin(), more.end(), mt19937(2));
+    ASSERT_EQ(20000u, chunked.Merge(more));
+    for (int i = 0; i < 20000; i++) {
+        ASSERT_EQ(i, chunked.IndexOf(i));
+    }
+
+    while (!chunked.IsEmpty()) {
+        chunked.Erase(chunked.Size() / 2);
+    }
+    ASSERT_TRUE(chunked.Begin() == chunked.End());
+    ASSERT_EQ(0, chunked.Add(7));
+    ASSERT_EQ(7, chunked[0]);
+}
+
+/*
+ * @tc.name: testChunkedSortedVector003
+ * @tc.desc: random Add time against SortedVector, whose Add is O(n), from 10k to 1M items,
+ *          10M items are in UtilsSortedVectorBenchmark
+ */
+namespace {
+template <class Vec>
+double AddSeconds(Vec& vec, const vector<int>& values)
+{
+    auto begin = chrono::steady_clock::now();
+    for (int value : values) {
+        vec.Add(value);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsChunkedSortedVector, testChunkedSortedVector003, TestSize.Level1)
+{
+    // SortedVector shifts n / 2 items per Add, from 1M items on it would run for minutes to hours
+    const size_t sortedVectorLimit = 100000;
+    for (size_t count : {10000u, 100000u, 1000000u}) {
+        vector<int> values(count);
+        mt19937 random(3);
+        for (auto& value : values) {
+            value = static_cast<int>(random());
+        }
+        ChunkedSortedVector<int> chunked;
+        double chunkedSeconds = AddSeconds(chunked, values);
+        cout << count << " random adds: ChunkedSortedVector " << chunkedSeconds << " s";
+        if (count <= sortedVectorLimit) {
+            SortedVector<int> svec;
+            cout << ", SortedVector " << AddSeconds(svec, values) << " s";
+        }
+        cout << endl;
+        ASSERT_EQ(count, chunked.Size());
+        ASSERT_TRUE(is_sorted(chunked.Begin(), chunked.End()));
+    }
+}
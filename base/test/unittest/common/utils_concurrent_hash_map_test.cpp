@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "concurrent_hash_map.h"
+#include "safe_map.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsConcurrentHashMap : public testing::Test {
+};
+
+/*
+ * @tc.name: testConcurrentHashMap001
+ * @tc.desc: single thread, same behavior as SafeMap for insert, find, update and erase
+ */
+HWTEST_F(UtilsConcurrentHashMap, testConcurrentHashMap001, TestSize.Level0)
+{
+    ConcurrentHashMap<string, int> demoData;
+    ASSERT_TRUE(demoData.IsEmpty());
+    ASSERT_TRUE(demoData.Insert("A", 1));
+    ASSERT_FALSE(demoData.Insert("A", 2));
+    ASSERT_EQ(demoData.Size(), 1);
+
+    int tar = -1;
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_EQ(1, tar);
+    ASSERT_FALSE(demoData.Find("B", tar));
+
+    demoData.EnsureInsert("A", 3);
+    demoData.EnsureInsert("B", 4);
+    ASSERT_EQ(demoData.Size(), 2);
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_EQ(3, tar);
+
+    int old = -1;
+    ASSERT_TRUE(demoData.FindOldAndSetNew("B", old, 5));
+    ASSERT_EQ(4, old);
+    ASSERT_TRUE(demoData.Find("B", tar));
+    ASSERT_EQ(5, tar);
+    ASSERT_FALSE(demoData.FindOldAndSetNew("C", old, 6));
+
+    ConcurrentHashMap<string, int> copied = demoData;
+    demoData.Erase("A");
+    demoData.Erase("C");
+    ASSERT_FALSE(demoData.Find("A", tar));
+    ASSERT_EQ(demoData.Size(), 1);
+    ASSERT_TRUE(copied.Find("A", tar));
+    ASSERT_EQ(3, tar);
+
+    demoData.Clear();
+    ASSERT_TRUE(demoData.IsEmpty());
+    copied = demoData;
+    ASSERT_TRUE(copied.IsEmpty());
+}
+
+/*
+ * @tc.name: testConcurrentHashMap002
+ * @tc.desc: tables grow and reuse erased slots, erased values are released at once
+ */
+HWTEST_F(UtilsConcurrentHashMap, testConcurrentHashMap002, TestSize.Level0)
+{
+    ConcurrentHashMap<int, shared_ptr<int>> demoData(4);
+    ASSERT_EQ(demoData.GetShardCount(), 4u);
+    const int count = 10000;
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(demoData.Insert(i, make_shared<int>(i)));
+    }
+    ASSERT_EQ(demoData.Size(), count);
+
+    shared_ptr<int> value;
+    ASSERT_TRUE(demoData.Find(count - 1, value));
+    weak_ptr<int> watcher = value;
+    value.reset();
+    demoData.Erase(count - 1);
+    ASSERT_TRUE(watcher.expired());
+
+    for (int i = 0; i < count; i += 2) {
+        demoData.Erase(i);
+    }
+    // churn on erased slots must not lose the remaining keys
+    for (int round = 0; round < 10; round++) {
+        for (int i = count; i < count + 1000; i++) {
+            ASSERT_TRUE(demoData.Insert(i, nullptr));
+        }
+        for (int i = count; i < count + 1000; i++) {
+            demoData.Erase(i);
+        }
+    }
+    ASSERT_EQ(demoData.Size(), count / 2 - 1);
+    for (int i = 0; i < count - 1; i++) {
+        ASSERT_EQ(demoData.Find(i, value), (i % 2) == 1);
+    }
+}
+
+/*
+ * @tc.name: testConcurrentHashMap003
+ * @tc.desc: many threads insert, update and erase at the same time
+ */
+HWTEST_F(UtilsConcurrentHashMap, testConcurrentHashMap003, TestSize.Level0)
+{
+    ConcurrentHashMap<int, int> demoData;
+    const int threads = 8;
+    const int perThread = 5000;
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&demoData, t]() {
+            for (int i = 0; i < perThread; i++) {
+                int key = t * perThread + i;
+                demoData.Insert(key, key);
+                demoData.EnsureInsert(key, key + 1);
+                if (i % 4 == 0) {
+                    demoData.Erase(key);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    ASSERT_EQ(demoData.Size(), threads * perThread * 3 / 4);
+    for (int key = 0; key < threads * perThread; key++) {
+        int value = -1;
+        bool found = demoData.Find(key, value);
+        ASSERT_EQ(found, (key % perThread) % 4 != 0);
+        if (found) {
+            ASSERT_EQ(key + 1, value);
+        }
+    }
+}
+
+/*
+ * @tc.name: testConcurrentHashMap004
+ * @tc.desc: lookup heavy throughput from 1 to 64 threads, against SafeMap
+ */
+namespace {
+template <typename Map>
+double MixedThroughput(Map& map, int threads, int keys, int totalOps)
+{
+    for (int i = 0; i < keys; i++) {
+        map.EnsureInsert(i, i);
+    }
+    std::atomic<bool> start(false);
+    vector<thread> workers;
+    int opsPerThread = totalOps / threads;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&map, &start, t, keys, opsPerThread]() {
+            while (!start) {
+                this_thread::yield();
+            }
+            uint32_t seed = static_cast<uint32_t>(t) * 2654435761u + 1;
+            int value = 0;
+            for (int i = 0; i < opsPerThread; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                int key = static_cast<int>((seed >> 8) % static_cast<uint32_t>(keys));
+                if ((seed & 0xf) == 0) { // 1 of 16 is a write
+                    map.EnsureInsert(key, i);
+                } else {
+                    map.Find(key, value);
+                }
+            }
+        });
+    }
+    auto begin = chrono::steady_clock::now();
+    start = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return opsPerThread * threads / elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsConcurrentHashMap, testConcurrentHashMap004, TestSize.Level1)
+{
+    const int keys = 10000;
+    const int totalOps = 400000;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        SafeMap<int, int> safeMap;
+        ConcurrentHashMap<int, int> hashMap;
+        double safeOps = MixedThroughput(safeMap, threads, keys, totalOps);
+        double hashOps = MixedThroughput(hashMap, threads, keys, totalOps);
+        cout << threads << " threads: SafeMap " << static_cast<uint64_t>(safeOps) << " ops/s, ConcurrentHashMap "
+             << static_cast<uint64_t>(hashOps) << " ops/s" << endl;
+        EXPECT_EQ(hashMap.Size(), keys);
+    }
+}
+
+/*
+ * @tc.name: testConcurrentHashMap005
+ * @tc.desc: a = b and b = a at the same time in two threads do not deadlock
+ */
+HWTEST_F(UtilsConcurrentHashMap, testConcurrentHashMap005, TestSize.Level0)
+{
+    // one shard each, so both threads always want the same two locks
+    ConcurrentHashMap<int, int> first(1);
+    ConcurrentHashMap<int, int> second(1);
+    const int count = 64;
+    const int rounds = 100000;
+    // an assignment clears the map the other thread copies from, so each round refills its source first
+    auto copyRounds = [count, rounds](ConcurrentHashMap<int, int>& to, ConcurrentHashMap<int, int>& from) {
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < count; i++) {
+                from.EnsureInsert(i, i);
+            }
+            to = from;
+        }
+    };
+    thread forward(copyRounds, ref(first), ref(second));
+    thread backward(copyRounds, ref(second), ref(first));
+    forward.join();
+    backward.join();
+
+    // a copy may see the other map half filled, but never a wrong value
+    for (int i = 0; i < count; i++) {
+        int value = -1;
+        if (first.Find(i, value)) {
+            ASSERT_EQ(i, value);
+        }
+        if (second.Find(i, value)) {
+            ASSERT_EQ(i, value);
+        }
+    }
+    ASSERT_LE(first.Size(), count);
+    ASSERT_LE(second.Size(), count);
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "event_loop_group.h"
+#include "common_timer_errors.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsEventLoopGroupTest : public testing::Test {
+};
+
+namespace {
+class Notifier {
+public:
+    void Notify()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_++;
+        cond_.notify_all();
+    }
+
+    bool WaitFor(int count, int timeoutMs = 1000)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, count] { return count_ >= count; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    int count_ = 0;
+};
+
+std::thread::id LoopThreadId(Utils::EventLoopGroup& group, uint32_t index)
+{
+    Notifier notifier;
+    std::thread::id id;
+    group.PostTask(index, [&]() {
+        id = std::this_thread::get_id();
+        notifier.Notify();
+    });
+    notifier.WaitFor(1);
+    return id;
+}
+
+void Signal(int fd)
+{
+    uint64_t one = 1;
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(one)), write(fd, &one, sizeof(one)));
+}
+
+void Drain(int fd)
+{
+    uint64_t value = 0;
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(value)), read(fd, &value, sizeof(value)));
+}
+}
+
+/*
+ * @tc.name: testEventLoopGroup001
+ * @tc.desc: round robin assignment, callbacks run in the loop of their fd
+ */
+HWTEST_F(UtilsEventLoopGroupTest, testEventLoopGroup001, TestSize.Level0)
+{
+    const uint32_t loops = 4;
+    Utils::EventLoopGroup group("test_group", loops);
+    EXPECT_EQ(loops, group.GetLoopCount());
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.Setup());
+    EXPECT_EQ(nullptr, group.GetLoop(loops));
+
+    std::vector<std::thread::id> loopThreads;
+    for (uint32_t i = 0; i < loops; i++) {
+        loopThreads.push_back(LoopThreadId(group, i));
+    }
+
+    const int fdCount = 8;
+    std::vector<int> fds;
+    std::vector<std::thread::id> callbackThreads(fdCount);
+    Notifier notifier;
+    for (int i = 0; i < fdCount; i++) {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+        Utils::EventLoop::FdCallbacks callbacks;
+        callbacks.onRead = [fd, i, &callbackThreads, &notifier]() {
+            Drain(fd);
+            callbackThreads[i] = std::this_thread::get_id();
+            notifier.Notify();
+        };
+        EXPECT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+        EXPECT_EQ(static_cast<int>(i % loops), group.GetLoopIndex(fd));
+    }
+    for (int fd : fds) {
+        Signal(fd);
+    }
+    EXPECT_TRUE(notifier.WaitFor(fdCount));
+    for (int i = 0; i < fdCount; i++) {
+        EXPECT_EQ(loopThreads[i % loops], callbackThreads[i]);
+        group.RemoveFd(fds[i]);
+        EXPECT_EQ(-1, group.GetLoopIndex(fds[i]));
+    }
+    group.Shutdown();
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+/*
+ * @tc.name: testEventLoopGroup002
+ * @tc.desc: hash assignment is stable for the same fd
+ */
+HWTEST_F(UtilsEventLoopGroupTest, testEventLoopGroup002, TestSize.Level0)
+{
+    Utils::EventLoopGroup group("test_group", 3, Utils::EventLoopGroup::AssignPolicy::HASH_FD, false);
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.Setup());
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+
+    Utils::EventLoop::FdCallbacks callbacks;
+    EXPECT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+    int index = group.GetLoopIndex(fd);
+    EXPECT_GE(index, 0);
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+    group.RemoveFd(fd);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+        EXPECT_EQ(index, group.GetLoopIndex(fd));
+        group.RemoveFd(fd);
+    }
+    group.Shutdown();
+    close(fd);
+}
+
+/*
+ * @tc.name: testEventLoopGroup003
+ * @tc.desc: migrate a fd to another loop, from outside and from its own callback
+ */
+HWTEST_F(UtilsEventLoopGroupTest, testEventLoopGroup003, TestSize.Level0)
+{
+    Utils::EventLoopGroup group("test_group", 3);
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.Setup());
+    std::vector<std::thread::id> loopThreads;
+    for (uint32_t i = 0; i < group.GetLoopCount(); i++) {
+        loopThreads.push_back(LoopThreadId(group, i));
+    }
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    Notifier notifier;
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&]() {
+        Drain(fd);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::this_thread::get_id());
+            if (threads.size() == 2) {
+                // move on from inside the callback
+                EXPECT_EQ(Utils::TIMER_ERR_OK, group.MigrateFd(fd, 2));
+            }
+        }
+        notifier.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+    int first = group.GetLoopIndex(fd);
+    ASSERT_GE(first, 0);
+    Signal(fd);
+    EXPECT_TRUE(notifier.WaitFor(1));
+
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, group.MigrateFd(fd, group.GetLoopCount()));
+    uint32_t second = (first == 1) ? 0 : 1;
+    EXPECT_EQ(Utils::TIMER_ERR_OK, group.MigrateFd(fd, second));
+    EXPECT_EQ(static_cast<int>(second), group.GetLoopIndex(fd));
+    // until the migration posted to the first loop ran, callbacks still run there; a task posted after it waits
+    LoopThreadId(group, static_cast<uint32_t>(first));
+    Signal(fd);
+    EXPECT_TRUE(notifier.WaitFor(2));
+    Signal(fd);
+    EXPECT_TRUE(notifier.WaitFor(3));
+
+    group.RemoveFd(fd);
+    group.Shutdown();
+    ASSERT_EQ(3u, threads.size());
+    EXPECT_EQ(loopThreads[first], threads[0]);
+    EXPECT_EQ(loopThreads[second], threads[1]);
+    EXPECT_EQ(loopThreads[2], threads[2]);
+    close(fd);
+}
+
+/*
+ * @tc.name: testEventLoopGroup004
+ * @tc.desc: tasks posted across loops, loops pinned to cores
+ */
+HWTEST_F(UtilsEventLoopGroupTest, testEventLoopGroup004, TestSize.Level0)
+{
+    const uint32_t loops = 2;
+    Utils::EventLoopGroup group("test_group", loops);
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.Setup());
+    std::thread::id second = LoopThreadId(group, 1);
+
+    Notifier notifier;
+    std::thread::id ranIn;
+    group.PostTask(0, [&]() {
+        group.PostTask(1, [&]() {
+            ranIn = std::this_thread::get_id();
+            notifier.Notify();
+        });
+    });
+    EXPECT_TRUE(notifier.WaitFor(1));
+    EXPECT_EQ(second, ranIn);
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, group.PostTask(loops, []() {}));
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, group.PostTaskToFd(-1, []() {}));
+
+    uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t i = 0; i < loops; i++) {
+        cpu_set_t cpuSet;
+        bool pinned = false;
+        group.PostTask(i, [&]() {
+            CPU_ZERO(&cpuSet);
+            pinned = (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0);
+            notifier.Notify();
+        });
+        EXPECT_TRUE(notifier.WaitFor(2 + i));
+        EXPECT_TRUE(pinned);
+        EXPECT_EQ(1, CPU_COUNT(&cpuSet));
+        EXPECT_TRUE(CPU_ISSET(i % cores, &cpuSet));
+    }
+    group.Shutdown();
+}
+
+/*
+ * @tc.name: testEventLoopGroup005
+ * @tc.desc: an fd removed while its migration is pending, then the fd number added again
+ */
+HWTEST_F(UtilsEventLoopGroupTest, testEventLoopGroup005, TestSize.Level0)
+{
+    // by fd number, the fd added again lands in the loop the first one is migrating from
+    Utils::EventLoopGroup group("test_group", 2, Utils::EventLoopGroup::AssignPolicy::HASH_FD);
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.Setup());
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    Notifier oldFd;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&oldFd]() { oldFd.Notify(); };
+    ASSERT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+    uint32_t fromLoop = static_cast<uint32_t>(group.GetLoopIndex(fd));
+
+    // the migration waits in the task queue of fromLoop behind a blocked task
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool blocked = false;
+    bool released = false;
+    group.PostTask(fromLoop, [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        blocked = true;
+        cond.notify_all();
+        cond.wait(lock, [&released] { return released; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&blocked] { return blocked; });
+    }
+    EXPECT_EQ(Utils::TIMER_ERR_OK, group.MigrateFd(fd, 1 - fromLoop));
+    Signal(fd);
+    group.RemoveFd(fd);
+
+    // the same fd number, another eventfd; no ASSERT until the loop is released
+    int newFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    EXPECT_EQ(fd, dup2(newFd, fd));
+    close(newFd);
+    Notifier sameNumber;
+    callbacks.onRead = [fd, &sameNumber]() {
+        Drain(fd);
+        sameNumber.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, group.AddFd(fd, Utils::EventLoop::READ, callbacks));
+    EXPECT_EQ(static_cast<int>(fromLoop), group.GetLoopIndex(fd));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        cond.notify_all();
+    }
+
+    // the stale migration leaves the new fd registered
+    Signal(fd);
+    EXPECT_TRUE(sameNumber.WaitFor(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Signal(fd);
+    EXPECT_TRUE(sameNumber.WaitFor(2));
+    EXPECT_EQ(static_cast<int>(fromLoop), group.GetLoopIndex(fd));
+    EXPECT_FALSE(oldFd.WaitFor(1, 20));
+    group.Shutdown();
+    close(fd);
+}
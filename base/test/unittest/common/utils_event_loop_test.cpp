@@ -0,0 +1,571 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "event_loop.h"
+#include "common_timer_errors.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsEventLoopTest : public testing::Test {
+};
+
+namespace {
+class Notifier {
+public:
+    void Notify()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_++;
+        cond_.notify_all();
+    }
+
+    bool WaitFor(int count, int timeoutMs = 1000)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, count] { return count_ >= count; });
+    }
+
+    int Count()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    int count_ = 0;
+};
+}
+
+/*
+ * @tc.name: testEventLoop001
+ * @tc.desc: read callback of a pipe
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop001, TestSize.Level0)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    Notifier notifier;
+    std::string received;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&]() {
+        char buf[16] = {0};
+        ssize_t n = read(fds[0], buf, sizeof(buf));
+        if (n > 0) {
+            received.append(buf, n);
+        }
+        EXPECT_TRUE(loop.IsInLoopThread());
+        notifier.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(fds[0], Utils::EventLoop::READ, callbacks));
+    EXPECT_NE(Utils::TIMER_ERR_OK, loop.AddFd(fds[0], Utils::EventLoop::READ, callbacks));
+    EXPECT_FALSE(loop.IsInLoopThread());
+
+    ASSERT_EQ(5, write(fds[1], "hello", 5));
+    EXPECT_TRUE(notifier.WaitFor(1));
+    loop.RemoveFd(fds[0]);
+    loop.Shutdown();
+    EXPECT_EQ("hello", received);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/*
+ * @tc.name: testEventLoop002
+ * @tc.desc: write and close callbacks, modify and remove from the loop thread
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop002, TestSize.Level0)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    Notifier writable;
+    Utils::EventLoop::FdCallbacks writeCallbacks;
+    writeCallbacks.onWrite = [&]() {
+        // level triggered, stop watching or it fires again at once
+        EXPECT_EQ(Utils::TIMER_ERR_OK, loop.ModifyFd(fds[1], 0));
+        writable.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(fds[1], Utils::EventLoop::WRITE, writeCallbacks));
+    EXPECT_TRUE(writable.WaitFor(1));
+
+    Notifier closed;
+    Utils::EventLoop::FdCallbacks readCallbacks;
+    readCallbacks.onClose = [&]() {
+        loop.RemoveFd(fds[0]);
+        closed.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(fds[0], Utils::EventLoop::READ, readCallbacks));
+    loop.RemoveFd(fds[1]);
+    close(fds[1]);
+    EXPECT_TRUE(closed.WaitFor(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop.Shutdown();
+    EXPECT_EQ(1, writable.Count());
+    EXPECT_EQ(1, closed.Count());
+    close(fds[0]);
+}
+
+/*
+ * @tc.name: testEventLoop003
+ * @tc.desc: periodic and once timers
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop003, TestSize.Level0)
+{
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    Notifier periodic;
+    Notifier once;
+    Notifier removed;
+    uint32_t periodicId = loop.AddTimer([&periodic]() { periodic.Notify(); }, std::chrono::milliseconds(5));
+    uint32_t onceId = loop.AddTimer([&once]() { once.Notify(); }, std::chrono::milliseconds(5), true);
+    uint32_t removedId = loop.AddTimer([&removed]() { removed.Notify(); }, std::chrono::milliseconds(20));
+    EXPECT_NE(periodicId, onceId);
+    EXPECT_NE(Utils::TIMER_ERR_DEAL_FAILED, removedId);
+    loop.RemoveTimer(removedId);
+
+    EXPECT_TRUE(periodic.WaitFor(4));
+    loop.RemoveTimer(periodicId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    int fired = periodic.Count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    loop.Shutdown();
+    EXPECT_EQ(fired, periodic.Count());
+    EXPECT_EQ(1, once.Count());
+    EXPECT_EQ(0, removed.Count());
+}
+
+/*
+ * @tc.name: testEventLoop004
+ * @tc.desc: tasks posted from other threads run in the loop thread, eventfd as the fd
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop004, TestSize.Level0)
+{
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    Notifier tasks;
+    const int posters = 4;
+    const int count = 100;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < posters; i++) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < count; j++) {
+                loop.PostTask([&]() {
+                    EXPECT_TRUE(loop.IsInLoopThread());
+                    tasks.Notify();
+                });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(tasks.WaitFor(posters * count));
+
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(efd, 0);
+    Notifier events;
+    uint64_t total = 0;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&]() {
+        uint64_t value = 0;
+        if (read(efd, &value, sizeof(value)) == sizeof(value)) {
+            total += value;
+            events.Notify();
+        }
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(efd, Utils::EventLoop::READ, callbacks));
+    uint64_t three = 3;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(three)), write(efd, &three, sizeof(three)));
+    EXPECT_TRUE(events.WaitFor(1));
+    loop.Shutdown();
+    EXPECT_EQ(3u, total);
+    close(efd);
+}
+
+/*
+ * @tc.name: testEventLoop005
+ * @tc.desc: one shot and edge triggered fds
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop005, TestSize.Level0)
+{
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+    int oneShotFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int edgeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(oneShotFd, 0);
+    ASSERT_GE(edgeFd, 0);
+
+    // neither callback reads, a level triggered fd would fire again and again
+    Notifier oneShot;
+    Notifier edge;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&oneShot]() { oneShot.Notify(); };
+    EXPECT_EQ(Utils::TIMER_ERR_OK,
+        loop.AddFd(oneShotFd, Utils::EventLoop::READ | Utils::EventLoop::ONE_SHOT, callbacks));
+    callbacks.onRead = [&edge]() { edge.Notify(); };
+    EXPECT_EQ(Utils::TIMER_ERR_OK,
+        loop.AddFd(edgeFd, Utils::EventLoop::READ | Utils::EventLoop::EDGE_TRIGGERED, callbacks));
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, loop.ModifyFd(edgeFd, 0x8000));
+
+    uint64_t one = 1;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(one)), write(oneShotFd, &one, sizeof(one)));
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(one)), write(edgeFd, &one, sizeof(one)));
+    EXPECT_TRUE(oneShot.WaitFor(1));
+    EXPECT_TRUE(edge.WaitFor(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(1, oneShot.Count());
+    EXPECT_EQ(1, edge.Count());
+
+    // re-arm the one shot fd, and make the edge fd change state
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.ModifyFd(oneShotFd, Utils::EventLoop::READ | Utils::EventLoop::ONE_SHOT));
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(one)), write(edgeFd, &one, sizeof(one)));
+    EXPECT_TRUE(oneShot.WaitFor(2));
+    EXPECT_TRUE(edge.WaitFor(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop.Shutdown();
+    EXPECT_EQ(2, oneShot.Count());
+    EXPECT_EQ(2, edge.Count());
+    close(oneShotFd);
+    close(edgeFd);
+}
+
+/*
+ * @tc.name: testEventLoop006
+ * @tc.desc: dispatch throughput with 10k active fds, level and edge triggered
+ */
+namespace {
+double MeasureActiveFds(const std::vector<int>& fds, uint32_t mode, int rounds,
+    Utils::DemultiplexerBackend backend = Utils::DemultiplexerBackend::EPOLL)
+{
+    Utils::EventLoop loop("test_loop", -1, CLOCK_MONOTONIC, backend);
+    if (loop.Setup() != Utils::TIMER_ERR_OK) {
+        return 0;
+    }
+    Notifier notifier;
+    std::atomic<int> pending(0);
+    for (int fd : fds) {
+        Utils::EventLoop::FdCallbacks callbacks;
+        callbacks.onRead = [fd, &pending, &notifier]() {
+            uint64_t value = 0;
+            if ((read(fd, &value, sizeof(value)) == sizeof(value)) && (--pending == 0)) {
+                notifier.Notify();
+            }
+        };
+        EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(fd, Utils::EventLoop::READ | mode, callbacks));
+    }
+
+    uint64_t one = 1;
+    auto begin = std::chrono::steady_clock::now();
+    for (int round = 1; round <= rounds; round++) {
+        pending = static_cast<int>(fds.size());
+        for (int fd : fds) {
+            EXPECT_EQ(static_cast<ssize_t>(sizeof(one)), write(fd, &one, sizeof(one)));
+        }
+        EXPECT_TRUE(notifier.WaitFor(round, 5000));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    loop.Shutdown();
+    return fds.size() * rounds / elapsed.count();
+}
+}
+
+HWTEST_F(UtilsEventLoopTest, testEventLoop006, TestSize.Level1)
+{
+    const rlim_t wanted = 10000;
+    const rlim_t reserved = 64;
+    struct rlimit limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+    if (limit.rlim_cur < wanted + reserved) {
+        limit.rlim_cur = std::min(limit.rlim_max, wanted + reserved);
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    size_t count = static_cast<size_t>(std::min(wanted, limit.rlim_cur - reserved));
+
+    std::vector<int> fds;
+    for (size_t i = 0; i < count; i++) {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+    }
+
+    const int rounds = 20;
+    double level = MeasureActiveFds(fds, 0, rounds);
+    double edge = MeasureActiveFds(fds, Utils::EventLoop::EDGE_TRIGGERED, rounds);
+    std::cout << count << " active fds, epoll level triggered: " << static_cast<uint64_t>(level)
+        << " events/s, edge triggered: " << static_cast<uint64_t>(edge) << " events/s" << std::endl;
+    EXPECT_GT(level, 0);
+    EXPECT_GT(edge, 0);
+
+    const Utils::DemultiplexerBackend uring = Utils::DemultiplexerBackend::IO_URING;
+    level = MeasureActiveFds(fds, 0, rounds, uring);
+    edge = MeasureActiveFds(fds, Utils::EventLoop::EDGE_TRIGGERED, rounds, uring);
+    std::cout << count << " active fds, io_uring level triggered: " << static_cast<uint64_t>(level)
+        << " events/s, edge triggered: " << static_cast<uint64_t>(edge) << " events/s" << std::endl;
+    EXPECT_GT(level, 0);
+    EXPECT_GT(edge, 0);
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+/*
+ * @tc.name: testEventLoop007
+ * @tc.desc: io_uring backend, or epoll where io_uring is not available
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop007, TestSize.Level0)
+{
+    Utils::EventLoop loop("test_loop", -1, CLOCK_MONOTONIC, Utils::DemultiplexerBackend::IO_URING);
+    std::cout << "backend: " << (loop.GetBackend() == Utils::DemultiplexerBackend::IO_URING ? "io_uring" : "epoll")
+        << std::endl;
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    int edgeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(edgeFd, 0);
+
+    // added before Setup, the poll is submitted by the first wait of the loop
+    Notifier readable;
+    Notifier closed;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&]() {
+        char buf[16] = {0};
+        if (read(fds[0], buf, sizeof(buf)) > 0) {
+            readable.Notify();
+        }
+    };
+    callbacks.onClose = [&]() {
+        loop.RemoveFd(fds[0]);
+        closed.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddFd(fds[0], Utils::EventLoop::READ, callbacks));
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    Notifier edge;
+    callbacks = Utils::EventLoop::FdCallbacks();
+    callbacks.onRead = [&edge]() { edge.Notify(); };
+    EXPECT_EQ(Utils::TIMER_ERR_OK,
+        loop.AddFd(edgeFd, Utils::EventLoop::READ | Utils::EventLoop::EDGE_TRIGGERED, callbacks));
+
+    Notifier timer;
+    Notifier task;
+    loop.AddTimer([&timer]() { timer.Notify(); }, std::chrono::milliseconds(2));
+    loop.PostTask([&task]() { task.Notify(); });
+
+    ASSERT_EQ(3, write(fds[1], "abc", 3));
+    EXPECT_TRUE(readable.WaitFor(1));
+    ASSERT_EQ(3, write(fds[1], "def", 3));
+    EXPECT_TRUE(readable.WaitFor(2));
+    uint64_t one = 1;
+    for (int i = 1; i <= 3; i++) {
+        ASSERT_EQ(static_cast<ssize_t>(sizeof(one)), write(edgeFd, &one, sizeof(one)));
+        EXPECT_TRUE(edge.WaitFor(i));
+    }
+    close(fds[1]);
+    EXPECT_TRUE(closed.WaitFor(1));
+    EXPECT_TRUE(timer.WaitFor(3));
+    EXPECT_TRUE(task.WaitFor(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop.Shutdown();
+    EXPECT_EQ(2, readable.Count());
+    EXPECT_EQ(1, closed.Count());
+    EXPECT_EQ(3, edge.Count());
+    close(fds[0]);
+    close(edgeFd);
+}
+
+/*
+ * @tc.name: testEventLoop008
+ * @tc.desc: signals handled in the loop thread through signalfd
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop008, TestSize.Level0)
+{
+    sigset_t mask;
+    sigset_t oldMask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGUSR2);
+    // blocked before the loop thread is created, the loop thread inherits the mask
+    ASSERT_EQ(0, pthread_sigmask(SIG_BLOCK, &mask, &oldMask));
+
+    Utils::EventLoop loop("test_loop");
+    Notifier usr1;
+    Notifier usr2;
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddSignal(SIGUSR1, [&](const struct signalfd_siginfo& info) {
+        EXPECT_EQ(static_cast<uint32_t>(SIGUSR1), info.ssi_signo);
+        EXPECT_TRUE(loop.IsInLoopThread());
+        usr1.Notify();
+    }));
+    EXPECT_EQ(Utils::TIMER_ERR_OK, loop.AddSignal(SIGUSR2, [&usr2](const struct signalfd_siginfo&) {
+        usr2.Notify();
+    }));
+    EXPECT_EQ(Utils::TIMER_ERR_INVALID_VALUE, loop.AddSignal(-1, nullptr));
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+
+    EXPECT_EQ(0, kill(getpid(), SIGUSR1));
+    EXPECT_TRUE(usr1.WaitFor(1));
+    EXPECT_EQ(0, kill(getpid(), SIGUSR2));
+    EXPECT_TRUE(usr2.WaitFor(1));
+    loop.RemoveSignal(SIGUSR2);
+    EXPECT_EQ(0, kill(getpid(), SIGUSR1));
+    EXPECT_TRUE(usr1.WaitFor(2));
+    loop.Shutdown();
+    EXPECT_EQ(2, usr1.Count());
+    EXPECT_EQ(1, usr2.Count());
+
+    // nothing is left pending before the old mask comes back
+    struct timespec noWait = {0, 0};
+    while (sigtimedwait(&mask, nullptr, &noWait) > 0) {
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+}
+
+/*
+ * @tc.name: testEventLoop009
+ * @tc.desc: directory changes through inotify
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop009, TestSize.Level0)
+{
+    char dirTemplate[] = "/tmp/utils_event_loop_XXXXXX";
+    char* dir = mkdtemp(dirTemplate);
+    ASSERT_NE(nullptr, dir);
+    std::string file = std::string(dir) + "/file";
+
+    Utils::EventLoop loop("test_loop");
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+    EXPECT_EQ(-1, loop.WatchPath(std::string(dir) + "/not_exist", IN_CREATE, nullptr));
+
+    std::mutex mutex;
+    std::vector<std::pair<uint32_t, std::string>> events;
+    Notifier notifier;
+    int wd = loop.WatchPath(dir, IN_CREATE | IN_DELETE, [&](int, uint32_t mask, uint32_t, const std::string& name) {
+        EXPECT_TRUE(loop.IsInLoopThread());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.emplace_back(mask, name);
+        }
+        notifier.Notify();
+    });
+    ASSERT_GE(wd, 0);
+
+    int fd = open(file.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    EXPECT_TRUE(notifier.WaitFor(1));
+    EXPECT_EQ(0, unlink(file.c_str()));
+    EXPECT_TRUE(notifier.WaitFor(2));
+
+    loop.UnwatchPath(wd);
+    fd = open(file.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop.Shutdown();
+    unlink(file.c_str());
+    rmdir(dir);
+
+    ASSERT_EQ(2u, events.size());
+    EXPECT_TRUE(events[0].first & IN_CREATE);
+    EXPECT_EQ("file", events[0].second);
+    EXPECT_TRUE(events[1].first & IN_DELETE);
+    EXPECT_EQ("file", events[1].second);
+}
+
+/*
+ * @tc.name: testEventLoop010
+ * @tc.desc: an edge triggered fd readable and writable at once gets both callbacks, on both backends
+ */
+namespace {
+void CheckReadWrite(uint32_t mode, Utils::DemultiplexerBackend backend)
+{
+    Utils::EventLoop loop("test_loop", -1, CLOCK_MONOTONIC, backend);
+    ASSERT_EQ(Utils::TIMER_ERR_OK, loop.Setup());
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds));
+    // readable before it is added, and writable as long as the socket buffer has room
+    ASSERT_EQ(1, write(fds[1], "x", 1));
+
+    Notifier reads;
+    Notifier writes;
+    Utils::EventLoop::FdCallbacks callbacks;
+    callbacks.onRead = [&]() {
+        // stays readable until the write callback ran, a read only dispatch would starve the write one
+        char buf[16] = {0};
+        if ((writes.Count() > 0) && (read(fds[0], buf, sizeof(buf)) > 0)) {
+            reads.Notify();
+        }
+    };
+    callbacks.onWrite = [&]() {
+        // nothing to write, a level triggered fd would stay writable; the change also re-arms an edge triggered fd
+        EXPECT_EQ(Utils::TIMER_ERR_OK, loop.ModifyFd(fds[0], Utils::EventLoop::READ | mode));
+        writes.Notify();
+    };
+    EXPECT_EQ(Utils::TIMER_ERR_OK,
+        loop.AddFd(fds[0], Utils::EventLoop::READ | Utils::EventLoop::WRITE | mode, callbacks));
+    EXPECT_TRUE(reads.WaitFor(1));
+    EXPECT_TRUE(writes.WaitFor(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop.Shutdown();
+    EXPECT_EQ(1, reads.Count());
+    EXPECT_EQ(1, writes.Count());
+    close(fds[0]);
+    close(fds[1]);
+}
+}
+
+HWTEST_F(UtilsEventLoopTest, testEventLoop010, TestSize.Level0)
+{
+    CheckReadWrite(Utils::EventLoop::EDGE_TRIGGERED, Utils::DemultiplexerBackend::EPOLL);
+    CheckReadWrite(Utils::EventLoop::EDGE_TRIGGERED, Utils::DemultiplexerBackend::IO_URING);
+}
+
+/*
+ * @tc.name: testEventLoop011
+ * @tc.desc: a level triggered socket added for READ | WRITE gets both callbacks while readable
+ */
+HWTEST_F(UtilsEventLoopTest, testEventLoop011, TestSize.Level0)
+{
+    CheckReadWrite(0, Utils::DemultiplexerBackend::EPOLL);
+    CheckReadWrite(0, Utils::DemultiplexerBackend::IO_URING);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lock_free_queue.h"
+#include "safe_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsLockFreeQueue : public testing::Test {
+};
+
+/*
+ * @tc.name: testLockFreeQueue001
+ * @tc.desc: single thread FIFO order, full and empty queue
+ */
+HWTEST_F(UtilsLockFreeQueue, testLockFreeQueue001, TestSize.Level0)
+{
+    LockFreeQueue<int> queue(5);
+    ASSERT_EQ(8u, queue.Capacity());
+    ASSERT_TRUE(queue.Empty());
+    int tar = -1;
+    ASSERT_FALSE(queue.Pop(tar));
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 8; i++) {
+            ASSERT_TRUE(queue.Push(i));
+        }
+        ASSERT_FALSE(queue.Push(8));
+        ASSERT_EQ(8, queue.Size());
+        for (int i = 0; i < 8; i++) {
+            ASSERT_TRUE(queue.Pop(tar));
+            ASSERT_EQ(i, tar);
+        }
+        ASSERT_FALSE(queue.Pop(tar));
+        ASSERT_TRUE(queue.Empty());
+    }
+}
+
+/*
+ * @tc.name: testLockFreeStack001
+ * @tc.desc: single thread LIFO order, full and empty stack
+ */
+HWTEST_F(UtilsLockFreeQueue, testLockFreeStack001, TestSize.Level0)
+{
+    LockFreeStack<int> stack(4);
+    ASSERT_TRUE(stack.Empty());
+    int tar = -1;
+    ASSERT_FALSE(stack.Pop(tar));
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(stack.Push(i));
+        }
+        ASSERT_FALSE(stack.Push(4));
+        ASSERT_EQ(4, stack.Size());
+        for (int i = 3; i >= 0; i--) {
+            ASSERT_TRUE(stack.Pop(tar));
+            ASSERT_EQ(i, tar);
+        }
+        ASSERT_FALSE(stack.Pop(tar));
+        ASSERT_TRUE(stack.Empty());
+    }
+}
+
+/*
+ * @tc.name: testLockFreeQueue002
+ * @tc.desc: many producers and consumers, every element is popped exactly once
+ */
+namespace {
+template <typename Container>
+void CheckExactlyOnce(Container& container, int producers, int consumers, int perProducer)
+{
+    const int total = producers * perProducer;
+    vector<atomic<int>> seen(total);
+    for (auto& count : seen) {
+        count = 0;
+    }
+    atomic<int> popped(0);
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&container, p, perProducer]() {
+            for (int i = 0; i < perProducer; i++) {
+                while (!container.Push(p * perProducer + i)) {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&container, &seen, &popped, total]() {
+            int value = 0;
+            while (popped < total) {
+                if (container.Pop(value)) {
+                    seen[value]++;
+                    popped++;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int i = 0; i < total; i++) {
+        ASSERT_EQ(1, seen[i]);
+    }
+    ASSERT_TRUE(container.Empty());
+}
+} // namespace
+
+HWTEST_F(UtilsLockFreeQueue, testLockFreeQueue002, TestSize.Level0)
+{
+    LockFreeQueue<int> queue(64);
+    CheckExactlyOnce(queue, 4, 4, 20000);
+    LockFreeStack<int> stack(64);
+    CheckExactlyOnce(stack, 4, 4, 20000);
+}
+
+/*
+ * @tc.name: testLockFreeQueue003
+ * @tc.desc: multi producer multi consumer throughput, against SafeQueue and SafeStack
+ */
+namespace {
+template <typename Container>
+double Throughput(Container& container, int pairs, int perProducer)
+{
+    atomic<bool> start(false);
+    atomic<int> popped(0);
+    const int total = pairs * perProducer;
+    vector<thread> threads;
+    for (int p = 0; p < pairs; p++) {
+        threads.emplace_back([&container, &start, perProducer]() {
+            while (!start) {
+                this_thread::yield();
+            }
+            for (int i = 0; i < perProducer; i++) {
+                while (!container.Push(i)) {
+                    this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&container, &start, &popped, total]() {
+            while (!start) {
+                this_thread::yield();
+            }
+            int value = 0;
+            while (popped.load(memory_order_relaxed) < total) {
+                if (container.Pop(value)) {
+                    popped.fetch_add(1, memory_order_relaxed);
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    auto begin = chrono::steady_clock::now();
+    start = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return total / elapsed.count();
+}
+
+// SafeQueue and SafeStack never refuse a push
+template <typename Safe>
+class Unbounded : public Safe {
+public:
+    bool Push(int value)
+    {
+        Safe::Push(value);
+        return true;
+    }
+};
+} // namespace
+
+HWTEST_F(UtilsLockFreeQueue, testLockFreeQueue003, TestSize.Level1)
+{
+    const int perProducer = 100000;
+    for (int pairs = 1; pairs <= 8; pairs *= 2) {
+        Unbounded<SafeQueue<int>> safeQueue;
+        LockFreeQueue<int> queue(1024);
+        Unbounded<SafeStack<int>> safeStack;
+        LockFreeStack<int> stack(1024);
+        cout << pairs << " producers + " << pairs << " consumers:"
+             << " SafeQueue " << static_cast<uint64_t>(Throughput(safeQueue, pairs, perProducer)) << " ops/s,"
+             << " LockFreeQueue " << static_cast<uint64_t>(Throughput(queue, pairs, perProducer)) << " ops/s,"
+             << " SafeStack " << static_cast<uint64_t>(Throughput(safeStack, pairs, perProducer)) << " ops/s,"
+             << " LockFreeStack " << static_cast<uint64_t>(Throughput(stack, pairs, perProducer)) << " ops/s" << endl;
+        EXPECT_TRUE(queue.Empty());
+        EXPECT_TRUE(stack.Empty());
+    }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "read_mostly_map.h"
+#include "safe_map.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsReadMostlyMap : public testing::Test {
+};
+
+/*
+ * @tc.name: testReadMostlyMap001
+ * @tc.desc: single thread, same behavior as SafeMap for insert, find, update and erase
+ */
+HWTEST_F(UtilsReadMostlyMap, testReadMostlyMap001, TestSize.Level0)
+{
+    ReadMostlyMap<string, int> demoData;
+    ASSERT_TRUE(demoData.IsEmpty());
+    ASSERT_TRUE(demoData.Insert("A", 1));
+    ASSERT_FALSE(demoData.Insert("A", 2));
+    ASSERT_EQ(demoData.Size(), 1);
+
+    int tar = -1;
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_EQ(1, tar);
+    ASSERT_FALSE(demoData.Find("0", tar));
+    ASSERT_FALSE(demoData.Find("B", tar));
+
+    demoData.EnsureInsert("A", 3);
+    demoData.EnsureInsert("B", 4);
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_EQ(3, tar);
+
+    int old = -1;
+    ASSERT_TRUE(demoData.FindOldAndSetNew("B", old, 5));
+    ASSERT_EQ(4, old);
+    ASSERT_TRUE(demoData.Find("B", tar));
+    ASSERT_EQ(5, tar);
+    ASSERT_FALSE(demoData.FindOldAndSetNew("C", old, 6));
+
+    ReadMostlyMap<string, int> copied = demoData;
+    demoData.Erase("A");
+    ASSERT_FALSE(demoData.Find("A", tar));
+    ASSERT_EQ(demoData.Size(), 1);
+    ASSERT_TRUE(copied.Find("A", tar));
+    ASSERT_EQ(3, tar);
+
+    demoData.Update([](map<string, int>& entries) {
+        entries["C"] = 7;
+        entries["D"] = 8;
+        entries.erase("B");
+    });
+    ASSERT_EQ(demoData.Size(), 2);
+    ASSERT_TRUE(demoData.Find("D", tar));
+    ASSERT_EQ(8, tar);
+
+    demoData.Clear();
+    ASSERT_TRUE(demoData.IsEmpty());
+    copied = demoData;
+    ASSERT_TRUE(copied.IsEmpty());
+}
+
+/*
+ * @tc.name: testReadMostlyMap002
+ * @tc.desc: readers always see a whole batch and old snapshots are freed while reading goes on
+ */
+HWTEST_F(UtilsReadMostlyMap, testReadMostlyMap002, TestSize.Level0)
+{
+    const int keys = 64;
+    ReadMostlyMap<int, shared_ptr<int>> demoData;
+    shared_ptr<int> first = make_shared<int>(0);
+    weak_ptr<int> watcher = first;
+    demoData.Update([&first](map<int, shared_ptr<int>>& entries) {
+        for (int i = 0; i < keys; i++) {
+            entries[i] = first;
+        }
+    });
+    first.reset();
+
+    atomic<bool> stop(false);
+    atomic<int> errors(0);
+    vector<thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            int last = 0;
+            while (!stop) {
+                for (int i = 0; i < keys; i++) {
+                    shared_ptr<int> value;
+                    // versions only go forward, keys never disappear
+                    if (!demoData.Find(i, value) || (*value < last)) {
+                        errors++;
+                        continue;
+                    }
+                    last = *value;
+                }
+            }
+        });
+    }
+    for (int version = 1; version <= 200; version++) {
+        shared_ptr<int> value = make_shared<int>(version);
+        demoData.Update([&value](map<int, shared_ptr<int>>& entries) {
+            for (auto& entry : entries) {
+                entry.second = value;
+            }
+        });
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, errors);
+    EXPECT_TRUE(watcher.expired());
+}
+
+/*
+ * @tc.name: testReadMostlyMap003
+ * @tc.desc: lookup throughput from 1 to 64 threads with rare writes, against SafeMap
+ */
+namespace {
+template <typename Map>
+double ReadThroughput(Map& map, int threads, int keys, int totalOps)
+{
+    for (int i = 0; i < keys; i++) {
+        map.EnsureInsert(i, i);
+    }
+    atomic<bool> start(false);
+    vector<thread> workers;
+    int opsPerThread = totalOps / threads;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&map, &start, t, keys, opsPerThread]() {
+            while (!start) {
+                this_thread::yield();
+            }
+            uint32_t seed = static_cast<uint32_t>(t) * 2654435761u + 1;
+            int value = 0;
+            for (int i = 0; i < opsPerThread; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                map.Find(static_cast<int>((seed >> 8) % static_cast<uint32_t>(keys)), value);
+            }
+        });
+    }
+    auto begin = chrono::steady_clock::now();
+    start = true;
+    map.EnsureInsert(0, 1);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return opsPerThread * threads / elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsReadMostlyMap, testReadMostlyMap003, TestSize.Level1)
+{
+    const int keys = 1000;
+    const int totalOps = 400000;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        SafeMap<int, int> safeMap;
+        ReadMostlyMap<int, int> readMostlyMap;
+        double safeOps = ReadThroughput(safeMap, threads, keys, totalOps);
+        double readMostlyOps = ReadThroughput(readMostlyMap, threads, keys, totalOps);
+        cout << threads << " threads: SafeMap " << static_cast<uint64_t>(safeOps) << " ops/s, ReadMostlyMap "
+             << static_cast<uint64_t>(readMostlyOps) << " ops/s" << endl;
+        EXPECT_EQ(readMostlyMap.Size(), keys);
+    }
+}
@@ -16,10 +16,16 @@
 #include "safe_block_queue.h"
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <iostream>
 
@@ -666,3 +672,290 @@ HWTEST_F(UtilsSafeBlockQueue, testMutilthreadConcurrentGetAndPopInfullqueue001,
         demoDatas[0].Get();
     }
 }
+
+/*
+ * @tc.name: testPushBatchAndPopBatch001
+ * @tc.desc: a batch larger than the capacity is pushed as consumers make room, PopBatch waits for elements
+ */
+HWTEST_F(UtilsSafeBlockQueue, testPushBatchAndPopBatch001, TestSize.Level0)
+{
+    SafeBlockQueue<int> qi(10);
+    vector<int> input(100);
+    for (int i = 0; i < 100; i++) {
+        input[i] = i;
+    }
+    vector<int> out;
+    std::thread consumer([&qi, &out]() {
+        while (out.size() < 100) {
+            ASSERT_GT(qi.PopBatch(out, 16), 0u);
+        }
+    });
+    qi.PushBatch(input.begin(), input.end());
+    consumer.join();
+    ASSERT_EQ(out, input);
+    ASSERT_TRUE(qi.IsEmpty());
+    ASSERT_EQ(qi.PopBatchNotWait(out, 16), 0u);
+}
+
+/*
+ * @tc.name: testDrainAll001
+ * @tc.desc: DrainAll takes every element at once and wakes producers blocked on a full queue
+ */
+HWTEST_F(UtilsSafeBlockQueue, testDrainAll001, TestSize.Level0)
+{
+    SafeBlockQueue<int> qi(3);
+    for (int i = 0; i < 3; i++) {
+        qi.Push(i);
+    }
+    std::thread producer([&qi]() {
+        vector<int> more = { 3, 4 };
+        qi.PushBatch(more.begin(), more.end());
+    });
+    std::queue<int> out;
+    size_t drained = 0;
+    while (drained < 5) {
+        drained += qi.DrainAll(out);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    producer.join();
+    ASSERT_EQ(out.size(), 5u);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(out.front(), i);
+        out.pop();
+    }
+}
+
+/*
+ * @tc.name: testMovePayload001
+ * @tc.desc: moved in elements are moved out again, their buffers are never copied
+ */
+HWTEST_F(UtilsSafeBlockQueue, testMovePayload001, TestSize.Level0)
+{
+    SafeBlockQueue<string> qs(10);
+    string payload(4096, 'a');
+    const char* buffer = payload.data();
+    qs.Push(std::move(payload));
+    string out = qs.Pop();
+    ASSERT_EQ(out.data(), buffer);
+
+    ASSERT_TRUE(qs.PushNoWait(std::move(out)));
+    string outNotWait;
+    ASSERT_TRUE(qs.PopNotWait(outNotWait));
+    ASSERT_EQ(outNotWait.data(), buffer);
+
+    qs.Emplace(4096, 'b');
+    ASSERT_EQ(qs.Pop(), string(4096, 'b'));
+
+    SafeBlockQueueTracking<string> qt(10);
+    qt.Push(string(4096, 'c'));
+    qt.Emplace(4096, 'd');
+    ASSERT_EQ(qt.GetUnfinishTaskNum(), 2);
+}
+
+/*
+ * @tc.name: testMovePayload002
+ * @tc.desc: producer and consumer throughput with 4 KB string payloads, copied in against moved in
+ */
+namespace {
+double PayloadThroughput(bool moveIn, int count)
+{
+    SafeBlockQueue<string> qs(256);
+    const string payload(4096, 'x');
+    vector<string> payloads(moveIn ? count : 0, payload);
+    auto begin = std::chrono::steady_clock::now();
+    std::thread consumer([&qs, count]() {
+        size_t bytes = 0;
+        for (int i = 0; i < count; i++) {
+            bytes += qs.Pop().size();
+        }
+        ASSERT_EQ(bytes, static_cast<size_t>(count) * 4096);
+    });
+    for (int i = 0; i < count; i++) {
+        if (moveIn) {
+            qs.Push(std::move(payloads[i]));
+        } else {
+            qs.Push(payload);
+        }
+    }
+    consumer.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return count / elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsSafeBlockQueue, testMovePayload002, TestSize.Level1)
+{
+    const int count = 10000;
+    cout << "4 KB payloads, copied in: " << static_cast<uint64_t>(PayloadThroughput(false, count)) << " ops/s, "
+         << "moved in: " << static_cast<uint64_t>(PayloadThroughput(true, count)) << " ops/s" << endl;
+}
+
+/*
+ * @tc.name: testTimedWait001
+ * @tc.desc: PushFor and PopFor give up after the timeout on a full or empty queue
+ */
+HWTEST_F(UtilsSafeBlockQueue, testTimedWait001, TestSize.Level0)
+{
+    SafeBlockQueue<int> qi(1);
+    int out = -1;
+    auto begin = std::chrono::steady_clock::now();
+    ASSERT_EQ(qi.PopFor(out, std::chrono::milliseconds(20)), BlockQueueStatus::TIMEOUT);
+    ASSERT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(20));
+
+    ASSERT_EQ(qi.PushFor(1, std::chrono::milliseconds(20)), BlockQueueStatus::OK);
+    ASSERT_EQ(qi.PushFor(2, std::chrono::milliseconds(20)), BlockQueueStatus::TIMEOUT);
+    ASSERT_EQ(qi.PopFor(out, std::chrono::milliseconds(20)), BlockQueueStatus::OK);
+    ASSERT_EQ(out, 1);
+
+    std::thread producer([&qi]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        qi.Push(3);
+    });
+    ASSERT_EQ(qi.PopFor(out, std::chrono::seconds(5)), BlockQueueStatus::OK);
+    ASSERT_EQ(out, 3);
+    producer.join();
+}
+
+/*
+ * @tc.name: testClose001
+ * @tc.desc: Close wakes blocked producers and consumers, the elements left can still be drained
+ */
+HWTEST_F(UtilsSafeBlockQueue, testClose001, TestSize.Level0)
+{
+    SafeBlockQueue<int> empty(1);
+    std::thread consumer([&empty]() {
+        int out = -1;
+        ASSERT_EQ(empty.PopFor(out, std::chrono::seconds(10)), BlockQueueStatus::CLOSED);
+        ASSERT_EQ(empty.Pop(), 0);
+    });
+
+    SafeBlockQueue<int> full(1);
+    full.Push(1);
+    std::thread producer([&full]() {
+        ASSERT_EQ(full.PushFor(2, std::chrono::seconds(10)), BlockQueueStatus::CLOSED);
+        full.Push(3);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto begin = std::chrono::steady_clock::now();
+    empty.Close();
+    full.Close();
+    consumer.join();
+    producer.join();
+    ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(1));
+
+    ASSERT_TRUE(full.IsClosed());
+    ASSERT_FALSE(full.PushNoWait(4));
+    int out = -1;
+    ASSERT_EQ(full.PopFor(out, std::chrono::milliseconds(1)), BlockQueueStatus::OK);
+    ASSERT_EQ(out, 1);
+    ASSERT_EQ(full.PopFor(out, std::chrono::milliseconds(1)), BlockQueueStatus::CLOSED);
+    vector<int> batch;
+    ASSERT_EQ(full.PopBatch(batch, 10), 0u);
+}
+
+/*
+ * @tc.name: testSignalOnlyWaiters001
+ * @tc.desc: SPSC round trip latency, SPSC and MPMC throughput, against a queue notifying on every operation
+ */
+namespace {
+// what SafeBlockQueue did before counting waiters
+class NotifyAlwaysQueue {
+public:
+    explicit NotifyAlwaysQueue(size_t capacity) : maxSize_(capacity) {}
+
+    void Push(int elem)
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        cvNotFull_.wait(lock, [&]() { return (queueT_.size() < maxSize_); });
+        queueT_.push(elem);
+        cvNotEmpty_.notify_one();
+    }
+
+    int Pop()
+    {
+        std::unique_lock<std::mutex> lock(mutexLock_);
+        cvNotEmpty_.wait(lock, [&] { return !queueT_.empty(); });
+        int elem = queueT_.front();
+        queueT_.pop();
+        cvNotFull_.notify_one();
+        return elem;
+    }
+
+private:
+    size_t maxSize_;
+    std::mutex mutexLock_;
+    std::condition_variable cvNotEmpty_;
+    std::condition_variable cvNotFull_;
+    std::queue<int> queueT_;
+};
+
+template <typename Queue>
+double RoundTripMicros(int rounds)
+{
+    Queue ping(1);
+    Queue pong(1);
+    std::thread echo([&ping, &pong, rounds]() {
+        for (int i = 0; i < rounds; i++) {
+            pong.Push(ping.Pop());
+        }
+    });
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        ping.Push(i);
+        pong.Pop();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+    echo.join();
+    return elapsed.count() / rounds;
+}
+
+template <typename Queue>
+double PushPopThroughput(int producers, int consumers, int perProducer)
+{
+    Queue queue(1024);
+    const int total = producers * perProducer;
+    std::atomic<int> left(total);
+    vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, perProducer]() {
+            for (int i = 0; i < perProducer; i++) {
+                queue.Push(i);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        // every consumer pops its share, so none is left blocked at the end
+        int share = total / consumers + ((c < total % consumers) ? 1 : 0);
+        threads.emplace_back([&queue, &left, share]() {
+            for (int i = 0; i < share; i++) {
+                queue.Pop();
+                left--;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_EQ(left, 0);
+    return total / elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsSafeBlockQueue, testSignalOnlyWaiters001, TestSize.Level1)
+{
+    const int rounds = 20000;
+    cout << "SPSC round trip: notify always " << RoundTripMicros<NotifyAlwaysQueue>(rounds) << " us, "
+         << "SafeBlockQueue " << RoundTripMicros<SafeBlockQueue<int>>(rounds) << " us" << endl;
+    const int perProducer = 200000;
+    cout << "SPSC throughput: notify always "
+         << static_cast<uint64_t>(PushPopThroughput<NotifyAlwaysQueue>(1, 1, perProducer)) << " ops/s, "
+         << "SafeBlockQueue " << static_cast<uint64_t>(PushPopThroughput<SafeBlockQueue<int>>(1, 1, perProducer))
+         << " ops/s" << endl;
+    cout << "MPMC(4x4) throughput: notify always "
+         << static_cast<uint64_t>(PushPopThroughput<NotifyAlwaysQueue>(4, 4, perProducer / 4)) << " ops/s, "
+         << "SafeBlockQueue " << static_cast<uint64_t>(PushPopThroughput<SafeBlockQueue<int>>(4, 4, perProducer / 4))
+         << " ops/s" << endl;
+}
@@ -18,6 +18,7 @@
 #include <future>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 #include <iostream>
 
@@ -690,3 +691,89 @@ HWTEST_F(UtilsSafeBlockQueueTracking, testMutilthreadConcurrentGetAndPopInfullqu
     ASSERT_TRUE(demoDatas[0].joinStatus);
     demoDatas[0].joinStatus = false;
 }
+
+/*
+ * @tc.name: testPushBatch001
+ * @tc.desc: every element of a batch counts as an unfinished task
+ */
+HWTEST_F(UtilsSafeBlockQueueTracking, testPushBatch001, TestSize.Level0)
+{
+    SafeBlockQueueTracking<int> qi(10);
+    vector<int> input = { 1, 2, 3, 4 };
+    qi.PushBatch(input.begin(), input.end());
+    ASSERT_EQ(qi.GetUnfinishTaskNum(), 4);
+    vector<int> out;
+    ASSERT_EQ(qi.PopBatch(out, 10), 4u);
+    for (size_t i = 0; i < out.size(); i++) {
+        ASSERT_TRUE(qi.OneTaskDone());
+    }
+    qi.Join();
+    ASSERT_EQ(qi.GetUnfinishTaskNum(), 0);
+}
+
+/*
+ * @tc.name: testClose001
+ * @tc.desc: pushes refused by a closed queue are not counted as unfinished tasks
+ */
+HWTEST_F(UtilsSafeBlockQueueTracking, testClose001, TestSize.Level0)
+{
+    SafeBlockQueueTracking<int> qi(1);
+    qi.Push(1);
+    std::thread producer([&qi]() {
+        qi.Push(2);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    qi.Close();
+    producer.join();
+    ASSERT_EQ(qi.GetUnfinishTaskNum(), 1);
+    ASSERT_EQ(qi.PushFor(3, std::chrono::milliseconds(1)), BlockQueueStatus::CLOSED);
+    ASSERT_EQ(qi.GetUnfinishTaskNum(), 1);
+    ASSERT_EQ(qi.Pop(), 1);
+    ASSERT_TRUE(qi.OneTaskDone());
+    qi.Join();
+}
+
+/*
+ * @tc.name: testStatistics001
+ * @tc.desc: residence and end-to-end latency, depth high-water mark and producer blocking time
+ */
+HWTEST_F(UtilsSafeBlockQueueTracking, testStatistics001, TestSize.Level0)
+{
+    SafeBlockQueueTracking<int> qi(2);
+    qi.Push(0);
+    qi.EnableStatistics(true);
+    qi.Push(1);
+
+    std::thread producer([&qi]() {
+        qi.Push(2); // blocks until the consumer makes room
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(qi.Pop(), 0);
+    producer.join();
+    ASSERT_TRUE(qi.OneTaskDone());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    vector<int> out;
+    ASSERT_EQ(qi.PopBatch(out, 2), 2u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(qi.OneTaskDone());
+    ASSERT_TRUE(qi.OneTaskDone());
+    qi.Join();
+
+    BlockQueueStatistics statistics = qi.GetStatistics();
+    // the task queued before statistics were enabled is not measured
+    EXPECT_EQ(statistics.residence.count, 2u);
+    EXPECT_EQ(statistics.endToEnd.count, 2u);
+    EXPECT_GE(statistics.residence.max, 20000000u); // 20ms in ns
+    EXPECT_GE(statistics.endToEnd.max, 25000000u);
+    EXPECT_EQ(statistics.producerBlocked.count, 1u);
+    EXPECT_GE(statistics.producerBlocked.max, 10000000u);
+    EXPECT_EQ(statistics.depthHighWater, 2u);
+
+    qi.ResetStatistics();
+    qi.EnableStatistics(false);
+    qi.Push(3);
+    ASSERT_EQ(qi.Pop(), 3);
+    ASSERT_TRUE(qi.OneTaskDone());
+    EXPECT_EQ(qi.GetStatistics().residence.count, 0u);
+}
@@ -18,7 +18,10 @@
 #include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <map>
+#include <string>
 #include <thread>
+#include <vector>
 #include <chrono> // std::chrono::seconds
 
 using namespace testing::ext;
@@ -373,3 +376,77 @@ HWTEST_F(UtilsSafeMap, testUtilsConcurrentWriteAndFindAndSet001, TestSize.Level0
         }
     });
 }
+
+/*
+ * @tc.name: testUtilsVisitor001
+ * @tc.desc: SafeMap reads and updates values in place, without copying them out
+ */
+HWTEST_F(UtilsSafeMap, testUtilsVisitor001, TestSize.Level0)
+{
+    SafeMap<string, vector<int>> demoData;
+    ASSERT_TRUE(demoData.Insert("A", vector<int>(100, 1)));
+    ASSERT_FALSE(demoData.FindAndApply("B", [](const vector<int>&) {}));
+
+    size_t size = 0;
+    ASSERT_TRUE(demoData.FindAndApply("A", [&size](const vector<int>& value) { size = value.size(); }));
+    ASSERT_EQ(100u, size);
+
+    ASSERT_TRUE(demoData.UpdateInPlace("A", [](vector<int>& value) { value.push_back(2); }));
+    ASSERT_FALSE(demoData.UpdateInPlace("B", [](vector<int>& value) { value.push_back(2); }));
+    vector<int> tar;
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_EQ(101u, tar.size());
+    ASSERT_EQ(2, tar.back());
+
+    int created = 0;
+    auto creator = [&created]() {
+        created++;
+        return vector<int>(1, 3);
+    };
+    ASSERT_FALSE(demoData.ComputeIfAbsent("A", creator));
+    ASSERT_TRUE(demoData.ComputeIfAbsent("B", creator));
+    ASSERT_EQ(1, created);
+    ASSERT_EQ(demoData.Size(), 2);
+
+    string keys;
+    demoData.Iterate([&keys](const string& key, vector<int>& value) {
+        keys += key;
+        value.clear();
+    });
+    ASSERT_EQ("AB", keys);
+    ASSERT_TRUE(demoData.Find("A", tar));
+    ASSERT_TRUE(tar.empty());
+}
+
+/*
+ * @tc.name: testUtilsBatch001
+ * @tc.desc: SafeMap batch insert and conditional erase, move-aware insert
+ */
+HWTEST_F(UtilsSafeMap, testUtilsBatch001, TestSize.Level0)
+{
+    SafeMap<int, string> demoData;
+    demoData.Insert(1, "old");
+    std::map<int, string> batch = { {1, "one"}, {2, "two"}, {3, "three"}, {4, "four"} };
+    ASSERT_EQ(3u, demoData.InsertAll(batch.begin(), batch.end()));
+    ASSERT_EQ(demoData.Size(), 4);
+    string tar;
+    ASSERT_TRUE(demoData.Find(1, tar));
+    ASSERT_EQ("old", tar);
+
+    ASSERT_EQ(2u, demoData.EraseIf([](const int& key, const string&) { return key % 2 == 0; }));
+    ASSERT_EQ(demoData.Size(), 2);
+    ASSERT_FALSE(demoData.Find(2, tar));
+
+    string value(64, 'x');
+    ASSERT_TRUE(demoData.Insert(5, std::move(value)));
+    ASSERT_TRUE(demoData.Find(5, tar));
+    ASSERT_EQ(64u, tar.size());
+
+    string duplicate("kept");
+    ASSERT_FALSE(demoData.Insert(5, std::move(duplicate)));
+    ASSERT_EQ("kept", duplicate);
+
+    demoData.EnsureInsert(5, string("new"));
+    ASSERT_TRUE(demoData.Find(5, tar));
+    ASSERT_EQ("new", tar);
+}
@@ -17,8 +17,11 @@
 #include <array>
 #include <future>
 #include <gtest/gtest.h>
+#include <deque>
 #include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
 #include <chrono>   // std::chrono::seconds
 
 using namespace testing::ext;
@@ -285,3 +288,78 @@ HWTEST_F(UtilsSafeQueue, testMutilthreadConcurrentGetAndPopInNotEmptyQueue, Test
     putInTestThread.ResetStatus();
     getOutTestThread.ResetStatus();
 }
+
+/*
+ * @tc.name: testPushBatchAndPopBatch001
+ * @tc.desc: batch push and pop keep the order of Push and Pop for queue and stack
+ */
+HWTEST_F(UtilsSafeQueue, testPushBatchAndPopBatch001, TestSize.Level0)
+{
+    vector<int> input = { 1, 2, 3, 4, 5 };
+    SafeQueue<int> queue;
+    queue.PushBatch(input.begin(), input.end());
+    ASSERT_EQ(queue.Size(), 5);
+    vector<int> out;
+    ASSERT_EQ(queue.PopBatch(out, 3), 3u);
+    ASSERT_EQ(out, vector<int>({ 1, 2, 3 }));
+    ASSERT_EQ(queue.PopBatch(out, 10), 2u);
+    ASSERT_EQ(out, input);
+    ASSERT_EQ(queue.PopBatch(out, 10), 0u);
+
+    SafeStack<int> stack;
+    stack.PushBatch(input.begin(), input.end());
+    out.clear();
+    ASSERT_EQ(stack.PopBatch(out, 2), 2u);
+    ASSERT_EQ(out, vector<int>({ 5, 4 }));
+}
+
+/*
+ * @tc.name: testDrainAll001
+ * @tc.desc: DrainAll takes every element in Pop order and leaves the container empty
+ */
+HWTEST_F(UtilsSafeQueue, testDrainAll001, TestSize.Level0)
+{
+    vector<int> input = { 1, 2, 3 };
+    SafeQueue<int> queue;
+    queue.PushBatch(input.begin(), input.end());
+    deque<int> out;
+    ASSERT_EQ(queue.DrainAll(out), 3u);
+    ASSERT_TRUE(queue.Empty());
+    ASSERT_EQ(out, deque<int>({ 1, 2, 3 }));
+    queue.Push(4);
+    ASSERT_EQ(queue.DrainAll(out), 1u);
+    ASSERT_EQ(out, deque<int>({ 1, 2, 3, 4 }));
+
+    SafeStack<int> stack;
+    stack.PushBatch(input.begin(), input.end());
+    out.clear();
+    ASSERT_EQ(stack.DrainAll(out), 3u);
+    ASSERT_TRUE(stack.Empty());
+    ASSERT_EQ(out, deque<int>({ 3, 2, 1 }));
+}
+
+/*
+ * @tc.name: testMovePayload001
+ * @tc.desc: queue and stack move elements in and out
+ */
+HWTEST_F(UtilsSafeQueue, testMovePayload001, TestSize.Level0)
+{
+    SafeQueue<string> queue;
+    string payload(4096, 'a');
+    const char* buffer = payload.data();
+    queue.Push(std::move(payload));
+    queue.Emplace(3, 'b');
+    string out;
+    ASSERT_TRUE(queue.Pop(out));
+    ASSERT_EQ(out.data(), buffer);
+    ASSERT_TRUE(queue.Pop(out));
+    ASSERT_EQ(out, "bbb");
+
+    SafeStack<string> stack;
+    stack.Push(std::move(out));
+    stack.Emplace(4096, 'c');
+    vector<string> batch;
+    ASSERT_EQ(stack.PopBatch(batch, 2), 2u);
+    ASSERT_EQ(batch[0], string(4096, 'c'));
+    ASSERT_EQ(batch[1], "bbb");
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "sharded_timer.h"
+#include "common_timer_errors.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsShardedTimerTest : public testing::Test {
+};
+
+/*
+ * @tc.name: testShardedTimer001
+ * @tc.desc: timers are spread over shards and all of them fire
+ */
+HWTEST_F(UtilsShardedTimerTest, testShardedTimer001, TestSize.Level0)
+{
+    const uint32_t shards = 4;
+    Utils::ShardedTimer timer("test_sharded", shards);
+    EXPECT_EQ(shards, timer.GetShardCount());
+    EXPECT_EQ(Utils::TIMER_ERR_OK, timer.Setup());
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> count(0);
+    const int timers = 16;
+    for (int i = 0; i < timers; i++) {
+        timer.Register([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            count++;
+        }, 10, true);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    timer.Shutdown();
+    EXPECT_EQ(timers, count);
+    EXPECT_EQ(shards, threads.size());
+}
+
+/*
+ * @tc.name: testShardedTimer002
+ * @tc.desc: ids are unique across shards and unregister reaches the right shard
+ */
+HWTEST_F(UtilsShardedTimerTest, testShardedTimer002, TestSize.Level0)
+{
+    Utils::ShardedTimer timer("test_sharded", 3);
+    EXPECT_EQ(Utils::TIMER_ERR_OK, timer.Setup());
+
+    std::atomic<int> kept(0);
+    std::atomic<int> removed(0);
+    std::set<uint32_t> ids;
+    std::vector<uint32_t> toRemove;
+    for (int i = 0; i < 6; i++) {
+        uint32_t id = timer.Register([&kept]() { kept++; }, 10);
+        EXPECT_TRUE(ids.insert(id).second);
+        id = timer.Register([&removed]() { removed++; }, std::chrono::milliseconds(10));
+        EXPECT_TRUE(ids.insert(id).second);
+        toRemove.push_back(id);
+    }
+    for (uint32_t id : toRemove) {
+        timer.Unregister(id);
+        timer.Unregister(id);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(55));
+    timer.Shutdown();
+    EXPECT_EQ(0, removed);
+    EXPECT_GE(kept, 6 * 3);
+}
+
+/*
+ * @tc.name: testShardedTimer003
+ * @tc.desc: timers of one caller thread live in one shard
+ */
+HWTEST_F(UtilsShardedTimerTest, testShardedTimer003, TestSize.Level0)
+{
+    Utils::ShardedTimer timer("test_sharded", 4, Utils::ShardedTimer::ShardPolicy::CALLER_THREAD);
+    EXPECT_EQ(Utils::TIMER_ERR_OK, timer.Setup());
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    for (int i = 0; i < 8; i++) {
+        timer.RegisterWithSlack([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }, std::chrono::milliseconds(5), std::chrono::milliseconds(1), true);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    timer.Shutdown();
+    EXPECT_EQ(1u, threads.size());
+}
+
+/*
+ * @tc.name: testShardedTimer004
+ * @tc.desc: register throughput from many threads, sharded against one Timer
+ */
+namespace {
+template <typename TimerType>
+double RegisterThroughput(TimerType& timer, int threads, int rounds)
+{
+    std::atomic<bool> start(false);
+    std::vector<std::thread> workers;
+    std::vector<std::vector<uint32_t>> ids(threads);
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([&timer, &start, &ids, i, rounds]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            for (int j = 0; j < rounds; j++) {
+                ids[i].push_back(timer.Register([]() {}, 100000));
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    for (auto& threadIds : ids) {
+        for (uint32_t id : threadIds) {
+            timer.Unregister(id);
+        }
+    }
+    return threads * rounds / elapsed.count();
+}
+}
+
+HWTEST_F(UtilsShardedTimerTest, testShardedTimer004, TestSize.Level0)
+{
+    const int threads = 32;
+    const int rounds = 200;
+    Utils::Timer single("test_single");
+    EXPECT_EQ(Utils::TIMER_ERR_OK, single.Setup());
+    double singleOps = RegisterThroughput(single, threads, rounds);
+    single.Shutdown();
+
+    Utils::ShardedTimer sharded("test_sharded", 8);
+    EXPECT_EQ(Utils::TIMER_ERR_OK, sharded.Setup());
+    double shardedOps = RegisterThroughput(sharded, threads, rounds);
+    sharded.Shutdown();
+
+    std::cout << threads << " threads register, Timer: " << static_cast<uint64_t>(singleOps)
+        << " ops/s, ShardedTimer(8): " << static_cast<uint64_t>(shardedOps) << " ops/s" << std::endl;
+    EXPECT_GT(shardedOps, 0);
+}
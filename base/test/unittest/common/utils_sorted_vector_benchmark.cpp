@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "chunked_sorted_vector.h"
+#include "sorted_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+/*
+ * Sizes too large for UtilsSortedVectorTest and UtilsChunkedSortedVectorTest,
+ * which run on devices with every unittest. Not part of the unittest group.
+ */
+class UtilsSortedVectorBenchmark : public testing::Test {
+};
+
+namespace {
+template <typename Func>
+double ElapsedSeconds(Func func)
+{
+    auto begin = chrono::steady_clock::now();
+    func();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+} // namespace
+
+/*
+ * @tc.name: testChunkedSortedVectorAdd001
+ * @tc.desc: 10M random adds to ChunkedSortedVector
+ */
+HWTEST_F(UtilsSortedVectorBenchmark, testChunkedSortedVectorAdd001, TestSize.Level1)
+{
+    const size_t count = 10000000;
+    vector<int> values(count);
+    mt19937 random(3);
+    for (auto& value : values) {
+        value = static_cast<int>(random());
+    }
+    ChunkedSortedVector<int> chunked;
+    double seconds = ElapsedSeconds([&]() {
+        for (int value : values) {
+            chunked.Add(value);
+        }
+    });
+    cout << count << " random adds: ChunkedSortedVector " << seconds << " s" << endl;
+    ASSERT_EQ(count, chunked.Size());
+    ASSERT_TRUE(is_sorted(chunked.Begin(), chunked.End()));
+}
+
+/*
+ * @tc.name: testSearchIndex001
+ * @tc.desc: 1M random OrderOf with and without the search index on 10M and 100M items
+ */
+HWTEST_F(UtilsSortedVectorBenchmark, testSearchIndex001, TestSize.Level1)
+{
+    const size_t lookups = 1000000;
+    for (size_t count : {10000000u, 100000000u}) {
+        vector<int> items(count);
+        for (size_t i = 0; i < count; i++) {
+            items[i] = static_cast<int>(i * 2);
+        }
+        SortedVector<int> svec;
+        svec.Merge(std::move(items));
+        const SortedVector<int>& reader = svec;
+
+        vector<int> keys(lookups);
+        mt19937 random(17);
+        uniform_int_distribution<int> values(0, static_cast<int>(count * 2));
+        generate(keys.begin(), keys.end(), [&]() { return values(random); });
+
+        size_t binarySum = 0;
+        double binarySeconds = ElapsedSeconds([&]() {
+            for (int key : keys) {
+                binarySum += reader.OrderOf(key);
+            }
+        });
+        svec.SetSearchIndex(true);
+        size_t indexedSum = 0;
+        double indexedSeconds = ElapsedSeconds([&]() {
+            for (int key : keys) {
+                indexedSum += reader.OrderOf(key);
+            }
+        });
+        cout << count << " items, " << lookups << " OrderOf: binary search " << binarySeconds
+             << " s, search index " << indexedSeconds << " s" << endl;
+        ASSERT_EQ(binarySum, indexedSum);
+    }
+}
@@ -14,8 +14,13 @@
  */
 #include "sorted_vector.h"
 
+#include <algorithm>
+#include <chrono>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
 
 using namespace testing::ext;
 using namespace OHOS;
@@ -595,3 +600,471 @@ HWTEST_F(UtilsSortedVector, testAddNotAllowDuplicate, TestSize.Level0)
         ASSERT_EQ(i, svec[i]);
     }
 }
+
+namespace {
+template <bool AllowDuplicate>
+void CheckMergeInPlace(int seed)
+{
+    mt19937 random(seed);
+    uniform_int_distribution<int> values(0, 500);
+    vector<int> head;
+    vector<int> tail;
+    for (int i = 0; i < 300; i++) {
+        head.push_back(values(random));
+    }
+    for (int i = 0; i < 200; i++) {
+        tail.push_back(values(random));
+    }
+    SortedVector<int, AllowDuplicate> svec(head);
+    SortedVector<int, AllowDuplicate> svec2(tail);
+
+    vector<int> expected(head);
+    expected.insert(expected.end(), tail.begin(), tail.end());
+    sort(expected.begin(), expected.end());
+    if (!AllowDuplicate) {
+        expected.erase(unique(expected.begin(), expected.end()), expected.end());
+    }
+
+    SortedVector<int, AllowDuplicate> copied(svec);
+    ASSERT_EQ(expected.size(), copied.Merge(svec2));
+    ASSERT_TRUE(equal(expected.begin(), expected.end(), copied.Begin()));
+
+    SortedVector<int, AllowDuplicate> moved(svec);
+    ASSERT_EQ(expected.size(), moved.Merge(std::move(svec2)));
+    ASSERT_TRUE(equal(expected.begin(), expected.end(), moved.Begin()));
+    ASSERT_TRUE(svec2.IsEmpty());
+
+    SortedVector<int, AllowDuplicate> fromVector(svec);
+    ASSERT_EQ(expected.size(), fromVector.Merge(tail));
+    ASSERT_TRUE(equal(expected.begin(), expected.end(), fromVector.Begin()));
+    ASSERT_EQ(expected.size(), svec.Merge(std::move(tail)));
+    ASSERT_TRUE(equal(expected.begin(), expected.end(), svec.Begin()));
+    ASSERT_TRUE(tail.empty());
+}
+
+struct NoDefault {
+    explicit NoDefault(int value) : value(value) {}
+    bool operator<(const NoDefault& rhs) const { return value < rhs.value; }
+    bool operator==(const NoDefault& rhs) const { return value == rhs.value; }
+    int value;
+};
+} // namespace
+
+HWTEST_F(UtilsSortedVector, testMergeInPlace, TestSize.Level0)
+{
+    for (int seed = 0; seed < 20; seed++) {
+        CheckMergeInPlace<true>(seed);
+        CheckMergeInPlace<false>(seed);
+    }
+
+    // into an empty vector, from an empty vector, with itself
+    SortedVector<int, false> svec;
+    ASSERT_EQ(static_cast<size_t>(3), svec.Merge(vector<int> {3, 1, 2, 1}));
+    ASSERT_EQ(static_cast<size_t>(3), svec.Merge(vector<int>()));
+    ASSERT_EQ(static_cast<size_t>(3), svec.Merge(svec));
+    SortedVector<int> dup(vector<int> {1, 2});
+    ASSERT_EQ(static_cast<size_t>(4), dup.Merge(dup));
+    ASSERT_EQ(2, dup[3]);
+
+    // items are moved in, equal items from the merged vector go after the existing ones
+    SortedVector<string> strings(vector<string> {"b", "d"});
+    vector<string> more {string(100, 'c'), "d", "a"};
+    strings.Merge(std::move(more));
+    ASSERT_EQ(static_cast<size_t>(5), strings.Size());
+    ASSERT_EQ("a", strings[0]);
+    ASSERT_EQ(string(100, 'c'), strings[2]);
+
+    SortedVector<NoDefault> noDefault(vector<NoDefault> {NoDefault(1), NoDefault(5)});
+    noDefault.Merge(vector<NoDefault> {NoDefault(3), NoDefault(0), NoDefault(9)});
+    ASSERT_EQ(static_cast<size_t>(5), noDefault.Size());
+    for (size_t i = 1; i < noDefault.Size(); i++) {
+        ASSERT_TRUE(noDefault[i - 1].value <= noDefault[i].value);
+    }
+}
+
+HWTEST_F(UtilsSortedVector, testParallelMerge, TestSize.Level0)
+{
+    mt19937 random(7);
+    uniform_int_distribution<int> values(0, 1000);
+    for (size_t threadNum = 1; threadNum <= 5; threadNum++) {
+        vector<int> head(1000 + threadNum);
+        vector<int> tail(777);
+        generate(head.begin(), head.end(), [&]() { return values(random); });
+        generate(tail.begin(), tail.end(), [&]() { return values(random); });
+
+        SortedVector<int> serial(head);
+        SortedVector<int> parallel(head);
+        SortedVector<int> other(tail);
+        ASSERT_EQ(serial.Merge(other), parallel.ParallelMerge(other, threadNum));
+        ASSERT_TRUE(equal(serial.Begin(), serial.End(), parallel.Begin()));
+
+        SortedVector<int, false> serialUnique(head);
+        SortedVector<int, false> parallelUnique(head);
+        SortedVector<int, false> otherUnique(tail);
+        ASSERT_EQ(serialUnique.Merge(otherUnique), parallelUnique.ParallelMerge(otherUnique, threadNum));
+        ASSERT_TRUE(equal(serialUnique.Begin(), serialUnique.End(), parallelUnique.Begin()));
+    }
+}
+
+namespace {
+template <typename Func>
+double ElapsedSeconds(Func func)
+{
+    auto begin = chrono::steady_clock::now();
+    func();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsSortedVector, testMergeBenchmark, TestSize.Level1)
+{
+    const int count = 4000000;
+    vector<int> head(count);
+    vector<int> tail(count);
+    mt19937 random(11);
+    generate(head.begin(), head.end(), [&]() { return static_cast<int>(random()); });
+    generate(tail.begin(), tail.end(), [&]() { return static_cast<int>(random()); });
+    SortedVector<int> sortedTail(tail);
+
+    // what Merge did before: a merged copy without reserve, swapped in
+    SortedVector<int> copied(head);
+    double copySeconds = ElapsedSeconds([&]() {
+        vector<int> newVec;
+        merge(copied.Begin(), copied.End(), sortedTail.Begin(), sortedTail.End(), back_inserter(newVec));
+    });
+    SortedVector<int> inPlace(head);
+    double inPlaceSeconds = ElapsedSeconds([&]() { inPlace.Merge(sortedTail); });
+    SortedVector<int> parallel(head);
+    double parallelSeconds = ElapsedSeconds([&]() { parallel.ParallelMerge(sortedTail, thread::hardware_concurrency()); });
+    cout << "merge 2 x " << count << " items: copy " << copySeconds << " s, in place " << inPlaceSeconds
+         << " s, parallel " << parallelSeconds << " s" << endl;
+    ASSERT_TRUE(equal(inPlace.Begin(), inPlace.End(), parallel.Begin()));
+}
+
+HWTEST_F(UtilsSortedVector, testAddDeferred, TestSize.Level0)
+{
+    mt19937 random(5);
+    uniform_int_distribution<int> values(0, 300);
+    SortedVector<int> added;
+    SortedVector<int> deferred;
+    SortedVector<int, false> deferredUnique;
+    deferred.BeginBatch(1000);
+    for (int i = 0; i < 1000; i++) {
+        int value = values(random);
+        added.Add(value);
+        deferred.AddDeferred(value);
+        deferredUnique.AddDeferred(value);
+    }
+    ASSERT_EQ(static_cast<size_t>(1000), deferred.DeferredSize());
+    ASSERT_EQ(static_cast<size_t>(1000), deferred.EndBatch());
+    ASSERT_EQ(static_cast<size_t>(0), deferred.DeferredSize());
+    ASSERT_TRUE(equal(added.Begin(), added.End(), deferred.Begin()));
+
+    // const calls see only the merged items, EndBatch merges the staged ones
+    const SortedVector<int, false>& reader = deferredUnique;
+    ASSERT_TRUE(reader.IsEmpty());
+    ASSERT_EQ(static_cast<ssize_t>(-1), reader.IndexOf(0));
+    ASSERT_EQ(static_cast<size_t>(1000), deferredUnique.DeferredSize());
+    deferredUnique.EndBatch();
+    ASSERT_EQ(0, reader.IndexOf(0));
+    ASSERT_EQ(static_cast<size_t>(0), deferredUnique.DeferredSize());
+    for (size_t i = 1; i < reader.Size(); i++) {
+        ASSERT_LT(reader[i - 1], reader[i]);
+    }
+
+    // deferred and direct adds mix, indexes are those after the merge
+    deferred.AddDeferred(-1);
+    deferred.AddDeferred(1000);
+    ASSERT_EQ(static_cast<ssize_t>(1), deferred.Add(-1));
+    ASSERT_EQ(1000, deferred.Back());
+    deferredUnique.AddDeferred(-5);
+    deferredUnique.AddDeferred(-5);
+    ASSERT_EQ(static_cast<ssize_t>(-1), deferredUnique.Add(-5));
+    ASSERT_EQ(-5, deferredUnique.Front());
+
+    SortedVector<int> copied;
+    copied.AddDeferred(3);
+    copied = deferred;
+    ASSERT_EQ(deferred.Size(), copied.Size());
+    copied.AddDeferred(3);
+    copied.Clear();
+    ASSERT_TRUE(copied.IsEmpty());
+}
+
+namespace {
+// threads reading the same const vector at once, which holds the even numbers below merged * 2
+void ReadConcurrently(const SortedVector<int>& reader, int merged)
+{
+    const int threadNum = 4;
+    vector<thread> threads;
+    for (int t = 0; t < threadNum; t++) {
+        threads.emplace_back([&reader, merged]() {
+            for (int round = 0; round < 20; round++) {
+                EXPECT_EQ(static_cast<size_t>(merged), reader.Size());
+                for (int i = 0; i < merged; i++) {
+                    EXPECT_EQ(i * 2, reader[i]);
+                    EXPECT_EQ(static_cast<ssize_t>(i), reader.IndexOf(i * 2));
+                    EXPECT_EQ(static_cast<ssize_t>(-1), reader.IndexOf(i * 2 + 1));
+                    EXPECT_EQ(static_cast<size_t>(i + 1), reader.OrderOf(i * 2 + 1));
+                }
+                EXPECT_TRUE(is_sorted(reader.Begin(), reader.End()));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+} // namespace
+
+HWTEST_F(UtilsSortedVector, testAddDeferredConstReaders, TestSize.Level0)
+{
+    const int merged = 1000;
+    SortedVector<int> svec;
+    for (int i = 0; i < merged; i++) {
+        svec.Add(i * 2);
+    }
+    for (int i = 0; i < merged; i++) {
+        svec.AddDeferred(i * 2 + 1);
+    }
+
+    // const readers neither see nor merge the deferred adds, so they do not change the vector under each other
+    ReadConcurrently(svec, merged);
+    ASSERT_EQ(static_cast<size_t>(merged), svec.DeferredSize());
+    ASSERT_EQ(static_cast<size_t>(merged * 2), svec.EndBatch());
+    for (int i = 0; i < merged * 2; i++) {
+        ASSERT_EQ(static_cast<ssize_t>(i), svec.IndexOf(i));
+    }
+}
+
+HWTEST_F(UtilsSortedVector, testAddDeferredBenchmark, TestSize.Level1)
+{
+    const int count = 200000;
+    vector<int> values(count);
+    mt19937 random(9);
+    generate(values.begin(), values.end(), [&]() { return static_cast<int>(random()); });
+
+    SortedVector<int> added;
+    double addSeconds = ElapsedSeconds([&]() {
+        for (int value : values) {
+            added.Add(value);
+        }
+    });
+    SortedVector<int> deferred;
+    double deferredSeconds = ElapsedSeconds([&]() {
+        deferred.BeginBatch(count);
+        for (int value : values) {
+            deferred.AddDeferred(value);
+        }
+        deferred.EndBatch();
+    });
+    cout << count << " random items: Add " << addSeconds << " s, AddDeferred " << deferredSeconds << " s" << endl;
+    ASSERT_TRUE(equal(added.Begin(), added.End(), deferred.Begin()));
+}
+
+namespace {
+template <class TYPE, bool AllowDuplicate>
+void ExpectIndexedSearch(SortedVector<TYPE, AllowDuplicate>& svec, const vector<TYPE>& keys)
+{
+    const SortedVector<TYPE, AllowDuplicate>& reader = svec;
+    svec.SetSearchIndex(false);
+    vector<ssize_t> indexes;
+    vector<size_t> orders;
+    for (const TYPE& key : keys) {
+        indexes.push_back(reader.IndexOf(key));
+        orders.push_back(reader.OrderOf(key));
+    }
+    svec.SetSearchIndex(true);
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(indexes[i], reader.IndexOf(keys[i]));
+        ASSERT_EQ(orders[i], reader.OrderOf(keys[i]));
+    }
+}
+} // namespace
+
+HWTEST_F(UtilsSortedVector, testSearchIndex, TestSize.Level0)
+{
+    mt19937 random(13);
+    for (size_t count : {0, 1, 15, 16, 17, 33, 1000, 10007}) {
+        uniform_int_distribution<int> values(0, static_cast<int>(count));
+        vector<int> items(count);
+        generate(items.begin(), items.end(), [&]() { return values(random); });
+        vector<int> keys;
+        for (int key = -2; key <= static_cast<int>(count) + 2; key++) {
+            keys.push_back(key);
+        }
+
+        SortedVector<int> svec(items);
+        ExpectIndexedSearch(svec, keys);
+        SortedVector<int, false> unique(items);
+        ExpectIndexedSearch(unique, keys);
+
+        vector<double> doubles(items.begin(), items.end());
+        vector<double> doubleKeys(keys.begin(), keys.end());
+        doubleKeys.push_back(0.5);
+        SortedVector<double> doubleVec(doubles);
+        ExpectIndexedSearch(doubleVec, doubleKeys);
+    }
+
+    // the index follows every change
+    SortedVector<int> svec(vector<int> {10, 20, 30});
+    svec.SetSearchIndex(true);
+    ASSERT_TRUE(svec.HasSearchIndex());
+    ASSERT_EQ(static_cast<ssize_t>(1), svec.IndexOf(20));
+    svec.Add(15);
+    ASSERT_EQ(static_cast<ssize_t>(2), svec.IndexOf(20));
+    svec.Erase(0);
+    ASSERT_EQ(static_cast<ssize_t>(1), svec.IndexOf(20));
+    // searches written items with a binary search until the next change rebuilds the index
+    svec.EditItemAt(1) = 25;
+    ASSERT_EQ(static_cast<ssize_t>(-1), svec.IndexOf(20));
+    ASSERT_EQ(static_cast<size_t>(2), svec.OrderOf(25));
+    svec.Merge(vector<int> {1, 2, 3});
+    ASSERT_EQ(static_cast<ssize_t>(4), svec.IndexOf(25));
+    for (int i = 100; i < 200; i++) {
+        svec.AddDeferred(i);
+    }
+    svec.EndBatch();
+    ASSERT_EQ(static_cast<ssize_t>(6), svec.IndexOf(100));
+    svec.Clear();
+    ASSERT_EQ(static_cast<ssize_t>(-1), svec.IndexOf(100));
+    ASSERT_EQ(static_cast<size_t>(0), svec.OrderOf(100));
+    svec.SetSearchIndex(false);
+    ASSERT_FALSE(svec.HasSearchIndex());
+
+    SortedVector<int> edited(vector<int> {10, 20, 30, 40});
+    edited.SetSearchIndex(true);
+    int* items = edited.EditArray();
+    for (int i = 0; i < 4; i++) {
+        items[i] += 1;
+    }
+    ASSERT_EQ(static_cast<ssize_t>(1), edited.IndexOf(21));
+    ASSERT_EQ(static_cast<ssize_t>(-1), edited.IndexOf(20));
+    for (auto it = edited.Begin(); it != edited.End(); ++it) {
+        *it -= 1;
+    }
+    ASSERT_EQ(static_cast<ssize_t>(3), edited.IndexOf(40));
+    edited.SetSearchIndex(true);
+    ASSERT_EQ(static_cast<ssize_t>(3), edited.IndexOf(40));
+    ASSERT_EQ(static_cast<size_t>(2), edited.OrderOf(25));
+}
+
+HWTEST_F(UtilsSortedVector, testSearchIndexConstReaders, TestSize.Level0)
+{
+    // the index is built by the change, searches from several threads only read it
+    const int merged = 1000;
+    SortedVector<int> svec;
+    svec.SetSearchIndex(true);
+    for (int i = 0; i < merged; i++) {
+        svec.Add(i * 2);
+    }
+    ReadConcurrently(svec, merged);
+    svec.Erase(merged - 1);
+    ReadConcurrently(svec, merged - 1);
+}
+
+namespace {
+// random Add, Erase and AddDeferred, each followed by indexed searches checked against a binary search of a copy
+template <bool AllowDuplicate>
+void ExpectIndexFollowsChanges(unsigned int seed)
+{
+    SortedVector<int, AllowDuplicate> svec;
+    const SortedVector<int, AllowDuplicate>& reader = svec;
+    svec.SetSearchIndex(true);
+    vector<int> expected;
+    mt19937 random(seed);
+    uniform_int_distribution<int> values(0, 3000);
+    uniform_int_distribution<int> operations(0, 9);
+    for (int step = 0; step < 2000; step++) {
+        int operation = operations(random);
+        if (operation < 5) {
+            int value = values(random);
+            bool duplicate = binary_search(expected.begin(), expected.end(), value);
+            ssize_t index = svec.Add(value);
+            if (AllowDuplicate || !duplicate) {
+                auto it = expected.insert(upper_bound(expected.begin(), expected.end(), value), value);
+                ASSERT_EQ(it - expected.begin(), index);
+            }
+        } else if (operation < 7 && !expected.empty()) {
+            size_t index = uniform_int_distribution<size_t>(0, expected.size() - 1)(random);
+            svec.Erase(index);
+            expected.erase(expected.begin() + index);
+        } else {
+            for (int i = 0; i < 20; i++) {
+                int value = values(random);
+                svec.AddDeferred(value);
+                if (AllowDuplicate || !binary_search(expected.begin(), expected.end(), value)) {
+                    expected.insert(upper_bound(expected.begin(), expected.end(), value), value);
+                }
+            }
+            svec.EndBatch();
+        }
+
+        for (int key = -1; key <= 3001; key += 7) {
+            auto lower = lower_bound(expected.begin(), expected.end(), key);
+            ssize_t index = (lower != expected.end() && *lower == key) ? (lower - expected.begin()) : -1;
+            ASSERT_EQ(index, reader.IndexOf(key));
+            ASSERT_EQ(static_cast<size_t>(upper_bound(expected.begin(), expected.end(), key) - expected.begin()),
+                reader.OrderOf(key));
+        }
+    }
+    ASSERT_TRUE(equal(expected.begin(), expected.end(), reader.Begin(), reader.End()));
+}
+} // namespace
+
+HWTEST_F(UtilsSortedVector, testSearchIndexChanges, TestSize.Level0)
+{
+    // an Add in front of items that were searched once shifts every item by one
+    SortedVector<int> svec;
+    for (int i = 0; i < 100; i++) {
+        svec.Add(i);
+    }
+    svec.SetSearchIndex(true);
+    ASSERT_EQ(static_cast<ssize_t>(50), svec.IndexOf(50));
+    svec.Add(-1);
+    for (int i = -1; i < 100; i++) {
+        ASSERT_EQ(static_cast<ssize_t>(i + 1), svec.IndexOf(i));
+        ASSERT_EQ(static_cast<size_t>(i + 2), svec.OrderOf(i));
+    }
+
+    ExpectIndexFollowsChanges<true>(19);
+    ExpectIndexFollowsChanges<false>(23);
+}
+
+// 10M and 100M items are in UtilsSortedVectorBenchmark
+HWTEST_F(UtilsSortedVector, testSearchIndexBenchmark, TestSize.Level1)
+{
+    const size_t lookups = 1000000;
+    for (size_t count = 1000; count <= 1000000; count *= 10) {
+        vector<int> items(count);
+        for (size_t i = 0; i < count; i++) {
+            items[i] = static_cast<int>(i * 2);
+        }
+        SortedVector<int> svec;
+        svec.Merge(std::move(items));
+        const SortedVector<int>& reader = svec;
+
+        vector<int> keys(lookups);
+        mt19937 random(17);
+        uniform_int_distribution<int> values(0, static_cast<int>(count * 2));
+        generate(keys.begin(), keys.end(), [&]() { return values(random); });
+
+        size_t binarySum = 0;
+        double binarySeconds = ElapsedSeconds([&]() {
+            for (int key : keys) {
+                binarySum += reader.OrderOf(key);
+            }
+        });
+        svec.SetSearchIndex(true);
+        size_t indexedSum = 0;
+        double indexedSeconds = ElapsedSeconds([&]() {
+            for (int key : keys) {
+                indexedSum += reader.OrderOf(key);
+            }
+        });
+        cout << count << " items, " << lookups << " OrderOf: binary search " << binarySeconds
+             << " s, search index " << indexedSeconds << " s" << endl;
+        ASSERT_EQ(binarySum, indexedSum);
+    }
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "spsc_ring_buffer.h"
+#include "safe_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace testing::ext;
+using namespace OHOS;
+using namespace std;
+
+class UtilsSpscRingBuffer : public testing::Test {
+};
+
+/*
+ * @tc.name: testSpscRingBuffer001
+ * @tc.desc: single thread FIFO order, full and empty buffer, wrap around
+ */
+HWTEST_F(UtilsSpscRingBuffer, testSpscRingBuffer001, TestSize.Level0)
+{
+    SpscRingBuffer<string, 4> ring;
+    ASSERT_EQ(4u, ring.Capacity());
+    ASSERT_TRUE(ring.Empty());
+    string out;
+    ASSERT_FALSE(ring.Pop(out));
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.Push(to_string(i)));
+        }
+        ASSERT_FALSE(ring.Push("full"));
+        ASSERT_EQ(4u, ring.Size());
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.Pop(out));
+            ASSERT_EQ(to_string(i), out);
+        }
+        ASSERT_FALSE(ring.Pop(out));
+    }
+}
+
+/*
+ * @tc.name: testSpscRingBuffer002
+ * @tc.desc: slots are filled and read in place, batches are seen once published
+ */
+HWTEST_F(UtilsSpscRingBuffer, testSpscRingBuffer002, TestSize.Level0)
+{
+    SpscRingBuffer<int, 8> ring;
+    for (int i = 0; i < 3; i++) {
+        int* slot = ring.Claim();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        ring.Commit(false);
+    }
+    ASSERT_EQ(ring.Peek(), nullptr);
+    ASSERT_TRUE(ring.Empty());
+    ring.Publish();
+    ASSERT_EQ(3u, ring.Size());
+
+    for (int i = 0; i < 3; i++) {
+        int* slot = ring.Peek();
+        ASSERT_NE(slot, nullptr);
+        ASSERT_EQ(i, *slot);
+        ring.Release(false);
+    }
+    ASSERT_EQ(ring.Peek(), nullptr);
+    ASSERT_EQ(3u, ring.Size());
+    ring.PublishReleased();
+    ASSERT_TRUE(ring.Empty());
+}
+
+/*
+ * @tc.name: testSpscRingBuffer003
+ * @tc.desc: the consumer sleeps on the eventfd and is woken by the producer
+ */
+HWTEST_F(UtilsSpscRingBuffer, testSpscRingBuffer003, TestSize.Level0)
+{
+    SpscRingBuffer<int, 16> ring(true);
+    ASSERT_GE(ring.GetEventFd(), 0);
+    ASSERT_FALSE(ring.Wait(10));
+
+    const int count = 10000;
+    std::thread producer([&ring]() {
+        for (int i = 0; i < count; i++) {
+            while (!ring.Push(i)) {
+                this_thread::yield();
+            }
+            if (i % 1000 == 0) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+    });
+    int expected = 0;
+    while (expected < count) {
+        ASSERT_TRUE(ring.Wait(5000));
+        int value = -1;
+        while (ring.Pop(value)) {
+            ASSERT_EQ(expected, value);
+            expected++;
+        }
+    }
+    producer.join();
+
+    SpscRingBuffer<int, 16> noEventFd;
+    ASSERT_LT(noEventFd.GetEventFd(), 0);
+    ASSERT_FALSE(noEventFd.PrepareWait());
+    ASSERT_FALSE(noEventFd.Wait(10));
+}
+
+/*
+ * @tc.name: testSpscRingBuffer004
+ * @tc.desc: one producer and one consumer thread throughput, against SafeQueue
+ */
+namespace {
+template <typename Push, typename Pop>
+double SpscThroughput(int count, Push push, Pop pop)
+{
+    auto begin = chrono::steady_clock::now();
+    std::thread producer([count, &push]() {
+        for (int i = 0; i < count; i++) {
+            while (!push(i)) {
+                this_thread::yield();
+            }
+        }
+    });
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        while (!pop(value)) {
+            this_thread::yield();
+        }
+    }
+    producer.join();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    return count / elapsed.count();
+}
+} // namespace
+
+HWTEST_F(UtilsSpscRingBuffer, testSpscRingBuffer004, TestSize.Level1)
+{
+    const int count = 10000000;
+    auto ring = make_unique<SpscRingBuffer<int, 4096>>();
+    double ringOps = SpscThroughput(count, [&ring](int value) { return ring->Push(value); },
+        [&ring](int& value) { return ring->Pop(value); });
+    SafeQueue<int> queue;
+    double queueOps = SpscThroughput(count / 10, [&queue](int value) {
+        queue.Push(value);
+        return true;
+    }, [&queue](int& value) { return queue.Pop(value); });
+    cout << "SPSC: SafeQueue " << static_cast<uint64_t>(queueOps) << " ops/s, SpscRingBuffer "
+         << static_cast<uint64_t>(ringOps) << " ops/s" << endl;
+    EXPECT_TRUE(ring->Empty());
+}
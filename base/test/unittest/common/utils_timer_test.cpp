@@ -19,6 +19,8 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <vector>
 #include <stdatomic.h>
 #include <sys/time.h>
 
@@ -337,3 +339,277 @@ HWTEST_F(UtilsTimerTest, testTimer011, TestSize.Level0)
     EXPECT_GE(g_data1, 8); /* 12 for max */
 }
 
+
+/*
+ * @tc.name: testTimer012
+ * @tc.desc: sub-millisecond interval timer register
+ */
+HWTEST_F(UtilsTimerTest, testTimer012, TestSize.Level0)
+{
+    g_data1 = 0;
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    uint32_t timerId = timer.Register(TimeOutCallback1, std::chrono::microseconds(500));
+    EXPECT_NE(Utils::TIMER_ERR_DEAL_FAILED, timerId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    timer.Unregister(timerId);
+    timer.Shutdown();
+    EXPECT_GE(g_data1, 50); /* 100 for max */
+}
+
+/*
+ * @tc.name: testTimer013
+ * @tc.desc: absolute deadline once timer register
+ */
+HWTEST_F(UtilsTimerTest, testTimer013, TestSize.Level0)
+{
+    g_data1 = 0;
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    std::chrono::nanoseconds deadline = timer.Now() + std::chrono::milliseconds(20);
+    std::chrono::nanoseconds fired(0);
+    timer.RegisterAt([&timer, &fired]() {
+        fired = timer.Now();
+        g_data1 += 1;
+    }, deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    timer.Shutdown();
+    EXPECT_EQ(1, g_data1);
+    EXPECT_GE(fired.count(), deadline.count());
+}
+
+/*
+ * @tc.name: testTimer014
+ * @tc.desc: absolute deadline periodic timer on CLOCK_BOOTTIME
+ */
+HWTEST_F(UtilsTimerTest, testTimer014, TestSize.Level0)
+{
+    g_data1 = 0;
+    g_data2 = 0;
+    Utils::Timer timer("test_timer", 1000, CLOCK_BOOTTIME);
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    timer.Register(TimeOutCallback2, 10);
+    uint32_t timerId = timer.RegisterAt(TimeOutCallback1, timer.Now() + std::chrono::milliseconds(5),
+        std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    timer.Unregister(timerId);
+    int count = g_data1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    timer.Shutdown();
+    EXPECT_GE(count, 8);  /* 10 for max */
+    EXPECT_EQ(count, g_data1);
+    EXPECT_GE(g_data2, 8);
+}
+
+/*
+ * @tc.name: testTimer015
+ * @tc.desc: jitter of sub-millisecond and millisecond periodic timers
+ */
+namespace {
+void MeasureJitter(std::chrono::nanoseconds interval, int rounds)
+{
+    Utils::Timer timer("test_timer");
+    EXPECT_EQ(Utils::TIMER_ERR_OK, timer.Setup());
+
+    std::vector<int64_t> fires;
+    fires.reserve(rounds);
+    std::chrono::nanoseconds start = timer.Now();
+    uint32_t timerId = timer.RegisterAt([&timer, &fires, rounds]() {
+        if (static_cast<int>(fires.size()) < rounds) {
+            fires.push_back(timer.Now().count());
+        }
+    }, start + interval, interval);
+    std::this_thread::sleep_for(interval * rounds + std::chrono::milliseconds(50));
+    timer.Unregister(timerId);
+    timer.Shutdown();
+
+    // lateness of the k-th fire against its deadline start + (k + 1) * interval, no drift is accumulated by
+    // absolute deadlines; a fire whole intervals late, or after merged expirations, counts all of it
+    ASSERT_FALSE(fires.empty());
+    std::vector<int64_t> lateness;
+    for (size_t k = 0; k < fires.size(); k++) {
+        lateness.push_back(fires[k] - (start.count() + static_cast<int64_t>(k + 1) * interval.count()));
+    }
+    int64_t ticks = (fires.back() - start.count()) / interval.count();
+    std::sort(lateness.begin(), lateness.end());
+    int64_t sum = 0;
+    for (int64_t late : lateness) {
+        sum += late;
+    }
+    const int percent = 100;
+    const int p99 = 99;
+    std::cout << "interval " << interval.count() << "ns, fired " << fires.size() << "/" << rounds
+        << ", lateness(ns) mean " << sum / static_cast<int64_t>(lateness.size())
+        << ", p50 " << lateness[lateness.size() / 2]
+        << ", p99 " << lateness[lateness.size() * p99 / percent]
+        << ", max " << lateness.back() << ", merged expirations " << ticks - static_cast<int64_t>(fires.size())
+        << std::endl;
+    EXPECT_GE(static_cast<int>(fires.size()), rounds / 2);
+}
+}
+
+HWTEST_F(UtilsTimerTest, testTimer015, TestSize.Level0)
+{
+    MeasureJitter(std::chrono::microseconds(100), 1000);
+    MeasureJitter(std::chrono::microseconds(500), 400);
+    MeasureJitter(std::chrono::milliseconds(1), 200);
+}
+
+/*
+ * @tc.name: testTimer016
+ * @tc.desc: slack timers with close intervals are batched into one wakeup
+ */
+HWTEST_F(UtilsTimerTest, testTimer016, TestSize.Level0)
+{
+    g_data1 = 0;
+    g_data2 = 0;
+    std::atomic<int> data3(0);
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    timer.RegisterWithSlack(TimeOutCallback1, std::chrono::milliseconds(100), std::chrono::milliseconds(10));
+    timer.RegisterWithSlack(TimeOutCallback2, std::chrono::milliseconds(101), std::chrono::milliseconds(10));
+    uint32_t timerId = timer.RegisterWithSlack([&data3]() { data3 += 1; }, std::chrono::milliseconds(103),
+        std::chrono::milliseconds(10));
+    EXPECT_NE(Utils::TIMER_ERR_DEAL_FAILED, timerId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    timer.Unregister(timerId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    timer.Shutdown();
+    EXPECT_GE(g_data1, 3);
+    EXPECT_GE(g_data2, 3);
+    EXPECT_EQ(data3, 2);
+    EXPECT_GE(timer.GetSavedWakeups(), 4u);
+}
+
+/*
+ * @tc.name: testTimer017
+ * @tc.desc: once slack timer fires only once and never before its deadline
+ */
+HWTEST_F(UtilsTimerTest, testTimer017, TestSize.Level0)
+{
+    g_data1 = 0;
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    std::chrono::nanoseconds deadline = timer.Now() + std::chrono::milliseconds(20);
+    std::chrono::nanoseconds fired(0);
+    timer.RegisterWithSlack([&timer, &fired]() {
+        fired = timer.Now();
+        g_data1 += 1;
+    }, std::chrono::milliseconds(20), std::chrono::milliseconds(5), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    timer.Shutdown();
+    EXPECT_EQ(1, g_data1);
+    EXPECT_GE(fired.count(), deadline.count());
+    EXPECT_LE(fired.count(), (deadline + std::chrono::milliseconds(25)).count());
+}
+
+/*
+ * @tc.name: testTimer018
+ * @tc.desc: shutdown wakes the loop up at once, whatever the epoll timeout is
+ */
+HWTEST_F(UtilsTimerTest, testTimer018, TestSize.Level0)
+{
+    const int timeouts[] = {-1, 1000, 5000};
+    for (int timeoutMs : timeouts) {
+        Utils::Timer timer("test_timer", timeoutMs);
+        uint32_t ret = timer.Setup();
+        EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+        timer.Register(TimeOutCallback1, 10000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        int64_t pre = CurMs();
+        timer.Shutdown();
+        int64_t cur = CurMs();
+        EXPECT_LE(cur - pre, 100);
+    }
+
+    Utils::Timer idle("test_timer");
+    EXPECT_EQ(Utils::TIMER_ERR_OK, idle.Setup());
+    int64_t pre = CurMs();
+    idle.Shutdown();
+    EXPECT_LE(CurMs() - pre, 100);
+}
+
+/*
+ * @tc.name: testTimer019
+ * @tc.desc: statistics of lateness, callback duration and missed expirations
+ */
+HWTEST_F(UtilsTimerTest, testTimer019, TestSize.Level0)
+{
+    g_data1 = 0;
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    uint32_t fastId = timer.Register(TimeOutCallback1, 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(0u, timer.GetStatistics().lateness.count); /* disabled by default */
+
+    timer.EnableStatistics(true);
+    uint32_t slowId = timer.Register([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }, 10);
+    uint32_t slackId = timer.RegisterWithSlack(TimeOutCallback1, std::chrono::milliseconds(20),
+        std::chrono::milliseconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    timer.EnableStatistics(false);
+
+    Utils::TimerStatistics fast;
+    Utils::TimerStatistics slow;
+    Utils::TimerStatistics slack;
+    EXPECT_TRUE(timer.GetStatistics(fastId, fast));
+    EXPECT_TRUE(timer.GetStatistics(slowId, slow));
+    EXPECT_TRUE(timer.GetStatistics(slackId, slack));
+    Utils::TimerStatistics all = timer.GetStatistics();
+    timer.Shutdown();
+
+    EXPECT_EQ(all.lateness.count, fast.lateness.count + slow.lateness.count + slack.lateness.count);
+    EXPECT_GE(slow.callbackDuration.max, 25000000u);
+    EXPECT_GE(slow.missedExpirations.max, 1u); /* 25ms callback on a 10ms timer */
+    EXPECT_GE(fast.missedExpirations.max, 1u); /* delayed by the slow callback on the same thread */
+    EXPECT_GE(slack.lateness.count, 3u);
+
+    timer.ResetStatistics();
+    EXPECT_EQ(0u, timer.GetStatistics().callbackDuration.count);
+}
+
+/*
+ * @tc.name: testTimer020
+ * @tc.desc: loop statistics of the timer thread, a slow callback is attributed to its handler
+ */
+HWTEST_F(UtilsTimerTest, testTimer020, TestSize.Level0)
+{
+    Utils::Timer timer("test_timer");
+    uint32_t ret = timer.Setup();
+    EXPECT_EQ(Utils::TIMER_ERR_OK, ret);
+    timer.Register(TimeOutCallback1, 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(0u, timer.GetReactorStatistics().waitTime.count); /* disabled by default */
+
+    timer.EnableReactorStatistics(true, std::chrono::milliseconds(10));
+    timer.Register([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    }, 40);
+    std::this_thread::sleep_for(std::chrono::milliseconds(130));
+    timer.EnableReactorStatistics(false);
+    Utils::ReactorStatistics statistics = timer.GetReactorStatistics();
+    timer.Shutdown();
+
+    /* wakeup eventfd and one timerfd per interval */
+    EXPECT_EQ(3u, statistics.handlerCount);
+    EXPECT_GE(statistics.waitTime.count, 10u);
+    EXPECT_EQ(statistics.waitTime.count, statistics.dispatchTime.count);
+    EXPECT_EQ(statistics.waitTime.count, statistics.eventsPerWakeup.count);
+    EXPECT_GE(statistics.handlerDuration.count, 10u);
+    EXPECT_GE(statistics.handlerDuration.max, 15000000u);
+    EXPECT_GE(statistics.dispatchTime.max, 15000000u);
+    EXPECT_GE(statistics.slowHandlers, 2u);
+    EXPECT_LE(statistics.slowHandlers, 4u);
+    EXPECT_GE(statistics.eventsPerWakeup.max, 1u);
+
+    timer.ResetReactorStatistics();
+    EXPECT_EQ(0u, timer.GetReactorStatistics().handlerDuration.count);
+}